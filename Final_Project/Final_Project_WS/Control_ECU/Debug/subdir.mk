@@ -7,36 +7,57 @@ C_SRCS += \
 ../DC_Motor.c \
 ../MC2.c \
 ../buzzer.c \
+../crc16.c \
+../credential.c \
 ../external_eeprom.c \
 ../gpio.c \
 ../lcd.c \
+../link.c \
 ../pwm.c \
+../sequence.c \
+../swtimer.c \
 ../timer1.c \
+../timer2.c \
 ../twi.c \
+../twi_bit_rate.c \
 ../uart.c 
 
 OBJS += \
 ./DC_Motor.o \
 ./MC2.o \
 ./buzzer.o \
+./crc16.o \
+./credential.o \
 ./external_eeprom.o \
 ./gpio.o \
 ./lcd.o \
+./link.o \
 ./pwm.o \
+./sequence.o \
+./swtimer.o \
 ./timer1.o \
+./timer2.o \
 ./twi.o \
+./twi_bit_rate.o \
 ./uart.o 
 
 C_DEPS += \
 ./DC_Motor.d \
 ./MC2.d \
 ./buzzer.d \
+./crc16.d \
+./credential.d \
 ./external_eeprom.d \
 ./gpio.d \
 ./lcd.d \
+./link.d \
 ./pwm.d \
+./sequence.d \
+./swtimer.d \
 ./timer1.d \
+./timer2.d \
 ./twi.d \
+./twi_bit_rate.d \
 ./uart.d 
 
 
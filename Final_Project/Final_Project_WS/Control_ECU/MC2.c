@@ -13,11 +13,14 @@
  *******************************************************************************/
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
 #include "uart.h"
+#include "link.h"
 #include "twi.h"
 #include "external_eeprom.h"
-#include "timer1.h"
+#include "credential.h"
+#include "sequence.h"
 #include "DC_Motor.h"
 #include "buzzer.h"
 
@@ -25,82 +28,164 @@
  *                                Definitions                                  *
  *******************************************************************************/
 
-#define MC1_READY           0x10
-#define MC2_READY           0x20
+/* Commands received from the HMI_ECU, each one is the type of a frame */
 #define OPEN_DOOR           0x30
 #define CHANGE_PASSWORD     0x40
 #define WRONG_PASSWORD      0x50
-#define PASSWORD_ADDRESS    0x0310
+#define NEW_PASSWORD        0x60
+#define CHECK_PASSWORD      0x70
+#define GET_STATUS          0x80
+
+/* One byte results sent back to the HMI_ECU in the reply frame */
 #define SAME                1
 #define NOT_SAME            0
 #define MATCHED             1
 #define NOT_MATCHED         0
-#define PASSWORD_SIZE       5
+#define COMMAND_ACCEPTED    1
+#define COMMAND_REJECTED    0xFF
+
+/* Reply of GET_STATUS: the remaining trials before the alarm then TRUE if a new password is expected */
+#define STATUS_TRIALS_LEFT_INDEX    0
+#define STATUS_NEW_PASSWORD_INDEX   1
+#define STATUS_SIZE                 2
+
+#define PASSWORD_SIZE       CREDENTIAL_PASSWORD_SIZE
 #define MAX_TRIALS          3
-#define DC_MOTOR_FINISHED   7
-#define BUZZER_FINISHED     10
 
-/*******************************************************************************
- *                      Functions Prototypes                                   *
- *******************************************************************************/
+/* Durations of the door and the alarm steps */
+#define DOOR_UNLOCKING_MS   15000
+#define DOOR_HOLD_MS        3000
+#define DOOR_LOCKING_MS     15000
+#define ALARM_MS            60000
 
 /*
- * Description :
- * The function responsible for receiving two passwords from the HMI_ECU through the UART.
+ * The EEPROM bus runs at the fastest SCL frequency of the master (222 kHz at 8 MHz, 400 kHz needs a TWBR
+ * below its minimum), the self-test can drop it to the standard mode.
  */
-void receiveTwoPasswordsFrom_HMI_ECU(uint8 *password_1, uint8 *password_2);
+#define TWI_SCL_FREQUENCY   TWI_SCL_MAX_HZ
+
+/*
+ * Uncomment to measure the EEPROM throughput at 100 kHz and TWI_SCL_FREQUENCY at every boot and keep the faster
+ * frequency which passes, the results are kept in g_twiSelfTest for the debugger.
+ */
+/* #define TWI_SELF_TEST */
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
 
 /*
  * Description :
- * The function responsible for check if the two passwords are the same or not then respond to the HMI_ECU though the UART.
+ * The function responsible for executing one command received from the HMI_ECU
+ * then replying to the HMI_ECU with the result in one frame.
  */
-uint8 checkSamePasswords(uint8 *password_1, uint8 *password_2);
+void dispatchCommand(const LINK_FrameType *frame);
 
 /*
  * Description :
- * The function responsible for saving the password in the EEPROM based on the address passed as a parameter.
+ * The function responsible for sending the one byte result of a command to the HMI_ECU
+ * in a reply frame with the same sequence number of the command frame.
  */
-void savePasswordInEEPROM(uint16 EEPROM_location, uint8 *password);
+void replyTo_HMI_ECU(const LINK_FrameType *command, uint8 result);
 
 /*
  * Description :
- * The function responsible for receiving the password from the HMI_ECU through the UART.
+ * The function responsible for check if the two passwords are the same or not.
  */
-void receivePasswordFrom_HMI_ECU(uint8 *password);
+uint8 checkSamePasswords(const uint8 *password_1, const uint8 *password_2);
 
 /*
  * Description :
- * The function responsible for checking if the password matches the one saved in the EEPROM or not
- * then responds to the HMI_ECU through the UART.
+ * The function responsible for saving the password in the EEPROM through the RAM password cache,
+ * it is verified before the next password check.
  */
-uint8 checkOnPassword(uint16 EEPROM_location, uint8 *HMI_password);
+uint8 savePasswordInEEPROM(const uint8 *password);
 
 /*
  * Description :
- * The function responsible for starting Timer1 based on the configurations passed as parameters
- * and pass the address of the call-back function.
+ * The function responsible for checking if the password matches the saved one or not,
+ * it is checked against the RAM password cache without reading the EEPROM.
  */
-void startTimer1(uint16 TCNT_value, uint16 OCR_value, Timer1_Prescaler prescaler, Timer1_Mode mode, void(*callBackFunctionAddress)(void));
+uint8 checkOnPassword(const uint8 *HMI_password);
 
 /*
  * Description :
  * The function responsible for rotating the DC-Motor clockwise for 15-seconds
  * then holding it for 3-seconds then rotating the DC-Motor anti-clockwise.
+ * The steps are run in the background by the sequence engine.
  */
 void APP_DcMotor(void);
 
 /*
  * Description :
  * The function responsible for activation the buzzer for 1-minute.
+ * The steps are run in the background by the sequence engine.
  */
 void APP_buzzer(void);
 
+/*
+ * Description :
+ * Step action of the door sequence, it rotates the DC-Motor in the required direction.
+ */
+void APP_rotateDoor(uint8 direction);
+
+/*
+ * Description :
+ * Step action of the alarm sequence, it turns the buzzer on (LOGIC_HIGH) or off (LOGIC_LOW).
+ */
+void APP_setBuzzer(uint8 state);
+
+/*
+ * Description :
+ * The function called at the end of the alarm sequence, the password can be checked again.
+ * An aborted alarm did not run its last step so the buzzer is turned off here.
+ */
+void APP_alarmFinished(SEQUENCE_Type *sequence);
+
+#ifdef TWI_SELF_TEST
+/*
+ * Description :
+ * The function responsible for measuring the EEPROM throughput at 100 kHz and TWI_SCL_FREQUENCY
+ * then running the bus at the faster frequency which passes.
+ */
+void selfTestTWI(void);
+#endif
+
 /*******************************************************************************
  *                           Global Variables                                  *
  *******************************************************************************/
 
-uint8 g_ticks_DCMotor;
-uint8 g_ticks_buzzer;
+/* Door: unlocking, hold then locking */
+const SEQUENCE_StepType g_doorSteps[] PROGMEM =
+{
+	{APP_rotateDoor, CLOCKWISE, DOOR_UNLOCKING_MS},
+	{APP_rotateDoor, STOP, DOOR_HOLD_MS},
+	{APP_rotateDoor, ANTI_CLOCKWISE, DOOR_LOCKING_MS},
+	{APP_rotateDoor, STOP, 0}
+};
+
+/* Alarm: the buzzer for 1-minute */
+const SEQUENCE_StepType g_alarmSteps[] PROGMEM =
+{
+	{APP_setBuzzer, LOGIC_HIGH, ALARM_MS},
+	{APP_setBuzzer, LOGIC_LOW, 0}
+};
+
+SEQUENCE_Type g_doorSequence;
+SEQUENCE_Type g_alarmSequence;
+
+/* Set while a new password is expected: no password is saved yet or a change is accepted */
+boolean g_newPasswordAllowed = TRUE;
+
+/* Set by a matched password and consumed by the next OPEN_DOOR or CHANGE_PASSWORD command */
+boolean g_passwordVerified = FALSE;
+
+/* Kept at MAX_TRIALS until the alarm is finished so no password is checked meanwhile */
+volatile uint8 g_wrongPasswordCounter = 0;
+
+#ifdef TWI_SELF_TEST
+EEPROM_SelfTestType g_twiSelfTest[2];
+#endif
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -108,135 +193,183 @@ uint8 g_ticks_buzzer;
 
 int main(void)
 {
-	uint8 firstPassword[5];
-	uint8 secondPassword[5];
-	uint8 doorPassword[5];
-	uint8 samePasswordFlag;
-	uint8 wrongPasswordCounter;
-	uint8 option;
+	LINK_FrameType frame;
 
 	SREG |= (1<<7);
 
-	TWI_ConfigType TWI_Configurations = {0b0000001, 0x02, ONE};
-	TWI_init(&TWI_Configurations);
+	TWI_initHz(TWI_SCL_FREQUENCY);
 
-	UART_ConfigType UART_Configurations = {EIGHT_BIT_DATA_MODE, DISABLED, ONE_STOP_BIT, 9600};
-	UART_init(&UART_Configurations);
+	/* The baud rate is raised later if the HMI_ECU offers a faster one */
+	UART_ConfigType UART_Configurations = {EIGHT_BIT_DATA_MODE, DISABLED, ONE_STOP_BIT, LINK_DEFAULT_BAUD_RATE};
+	LINK_init(&UART_Configurations);
 
 	DcMotor_Init();
 
 	Buzzer_init();
 
-	samePasswordFlag = SAME;
-	do
+	/* The door and the alarm run on software timers so the link is served while they are running */
+	SWTIMER_init();
+
+#ifdef TWI_SELF_TEST
+	/* It needs the Timer2 tick started by LINK_init */
+	selfTestTWI();
+#endif
+
+	/*
+	 * The saved password is read once, then every check uses its RAM copy. A saved password is kept
+	 * after a reset so a new one is expected only if none is found, the HMI_ECU asks by GET_STATUS.
+	 */
+	g_newPasswordAllowed = (CREDENTIAL_init() == TRUE) ? FALSE : TRUE;
+
+	while(1)
 	{
-		if(samePasswordFlag != SAME)
+		/* A corrupted frame is dropped without a reply */
+		if(LINK_OK == LINK_receiveFrame(&frame))
 		{
-			while(UART_recieveByte() != MC1_READY);
-			UART_sendByte(NOT_SAME);
+			/* A command sent again because its reply is lost gets the same reply without executing it twice */
+			if(!LINK_answerRepeatedRequest(&frame))
+			{
+				/* The payload is used in place in the UART Rx buffer then given back */
+				dispatchCommand(&frame);
+			}
+			LINK_releaseFrame();
 		}
-		receiveTwoPasswordsFrom_HMI_ECU(firstPassword, secondPassword);
-		samePasswordFlag++;
-	}while(NOT_SAME == checkSamePasswords(firstPassword, secondPassword));
-
-	while(UART_recieveByte() != MC1_READY);
-	UART_sendByte(SAME);
+	}
+	return 0;
+}
 
-	savePasswordInEEPROM(PASSWORD_ADDRESS, firstPassword);
+/*
+ * Description :
+ * The function responsible for executing one command received from the HMI_ECU
+ * then replying to the HMI_ECU with the result in one frame.
+ */
+void dispatchCommand(const LINK_FrameType *frame)
+{
+	uint8 status[STATUS_SIZE];
 
-	while(1)
+	switch(frame->type)
 	{
-		wrongPasswordCounter = 0;
-		while(wrongPasswordCounter < MAX_TRIALS)
+	case NEW_PASSWORD:
+		if((g_newPasswordAllowed == FALSE) || (frame->length != 2 * PASSWORD_SIZE))
+		{
+			replyTo_HMI_ECU(frame, COMMAND_REJECTED);
+		}
+		else if(SAME == checkSamePasswords(frame->payload, frame->payload + PASSWORD_SIZE))
 		{
-			receivePasswordFrom_HMI_ECU(doorPassword);
-			if(MATCHED == checkOnPassword(PASSWORD_ADDRESS, doorPassword))
+			/* The password is written in the background so the reply does not wait for the EEPROM write cycle */
+			if(savePasswordInEEPROM(frame->payload) == SUCCESS)
 			{
-				while(UART_recieveByte() != MC1_READY);
-				UART_sendByte(MATCHED);
-				break;
+				g_newPasswordAllowed = FALSE;
+				replyTo_HMI_ECU(frame, SAME);
 			}
-			else /* NOT_MATCHED */
+			else
 			{
-				while(UART_recieveByte() != MC1_READY);
-				UART_sendByte(NOT_MATCHED);
-				wrongPasswordCounter++;
+				replyTo_HMI_ECU(frame, COMMAND_REJECTED);
 			}
 		}
+		else
+		{
+			replyTo_HMI_ECU(frame, NOT_SAME);
+		}
+		break;
+
+	case CHECK_PASSWORD:
+		if((g_newPasswordAllowed == TRUE) || (frame->length != PASSWORD_SIZE) || (g_wrongPasswordCounter >= MAX_TRIALS))
+		{
+			replyTo_HMI_ECU(frame, COMMAND_REJECTED);
+		}
+		else if(MATCHED == checkOnPassword(frame->payload))
+		{
+			g_wrongPasswordCounter = 0;
+			g_passwordVerified = TRUE;
+			replyTo_HMI_ECU(frame, MATCHED);
+		}
+		else /* NOT_MATCHED */
+		{
+			g_wrongPasswordCounter++;
+			g_passwordVerified = FALSE;
+			replyTo_HMI_ECU(frame, NOT_MATCHED);
+		}
+		break;
 
-		if(wrongPasswordCounter == MAX_TRIALS)
+	case OPEN_DOOR:
+		if((g_passwordVerified == FALSE) || SEQUENCE_isBusy(&g_doorSequence))
+		{
+			replyTo_HMI_ECU(frame, COMMAND_REJECTED);
+		}
+		else
 		{
-			UART_sendByte(MC2_READY);
-			option = UART_recieveByte();
+			g_passwordVerified = FALSE;
+			replyTo_HMI_ECU(frame, COMMAND_ACCEPTED);
 
-			if(WRONG_PASSWORD == option)
-			{
-				g_ticks_buzzer = 0;
-				APP_buzzer();
-				while(g_ticks_buzzer != BUZZER_FINISHED);
-			}
+			/* The door is moved in the background */
+			APP_DcMotor();
+		}
+		break;
+
+	case CHANGE_PASSWORD:
+		if(g_passwordVerified == FALSE)
+		{
+			replyTo_HMI_ECU(frame, COMMAND_REJECTED);
 		}
 		else
 		{
-			UART_sendByte(MC2_READY);
-			option = UART_recieveByte();
+			g_passwordVerified = FALSE;
+			g_newPasswordAllowed = TRUE;
+			replyTo_HMI_ECU(frame, COMMAND_ACCEPTED);
+		}
+		break;
 
-			if(OPEN_DOOR == option)
-			{
-				g_ticks_DCMotor = 0;
-				APP_DcMotor();
-				while(g_ticks_DCMotor != DC_MOTOR_FINISHED);
-			}
-			else if(CHANGE_PASSWORD == option)
-			{
-				samePasswordFlag = SAME;
-				do
-				{
-					if(samePasswordFlag != SAME)
-					{
-						while(UART_recieveByte() != MC1_READY);
-						UART_sendByte(NOT_SAME);
-					}
-					receiveTwoPasswordsFrom_HMI_ECU(firstPassword, secondPassword);
-					samePasswordFlag++;
-				}while(NOT_SAME == checkSamePasswords(firstPassword, secondPassword));
-
-				while(UART_recieveByte() != MC1_READY);
-				UART_sendByte(SAME);
-
-				savePasswordInEEPROM(PASSWORD_ADDRESS, firstPassword);
-			}
+	case WRONG_PASSWORD:
+		if((g_wrongPasswordCounter < MAX_TRIALS) || SEQUENCE_isBusy(&g_alarmSequence))
+		{
+			replyTo_HMI_ECU(frame, COMMAND_REJECTED);
 		}
+		else
+		{
+			replyTo_HMI_ECU(frame, COMMAND_ACCEPTED);
+
+			/* The trials counter is cleared at the end of the alarm */
+			APP_buzzer();
+		}
+		break;
+
+	case GET_STATUS:
+		/* The HMI_ECU takes the remaining trials and, after a reset of any ECU, if a new password is expected */
+		status[STATUS_TRIALS_LEFT_INDEX] = MAX_TRIALS - g_wrongPasswordCounter;
+		status[STATUS_NEW_PASSWORD_INDEX] = g_newPasswordAllowed;
+		LINK_sendReply(frame, status, STATUS_SIZE);
+		break;
+
+	case LINK_BAUD_OFFER:
+		LINK_answerBaudRateOffer(frame);
+		break;
+
+	case LINK_GET_STATISTIC:
+		LINK_answerStatisticRequest(frame);
+		break;
+
+	default:
+		replyTo_HMI_ECU(frame, COMMAND_REJECTED);
+		break;
 	}
-	return 0;
 }
 
 /*
  * Description :
- * The function responsible for receiving two passwords from the HMI_ECU through the UART.
+ * The function responsible for sending the one byte result of a command to the HMI_ECU
+ * in a reply frame with the same sequence number of the command frame.
  */
-void receiveTwoPasswordsFrom_HMI_ECU(uint8 *password_1, uint8 *password_2)
+void replyTo_HMI_ECU(const LINK_FrameType *command, uint8 result)
 {
-	uint8 i;
-
-	for(i = 0; i < PASSWORD_SIZE; i++)
-	{
-		UART_sendByte(MC2_READY);
-		password_1[i] = UART_recieveByte();
-	}
-
-	for(i = 0; i < PASSWORD_SIZE; i++)
-	{
-		UART_sendByte(MC2_READY);
-		password_2[i] = UART_recieveByte();
-	}
+	LINK_sendReply(command, &result, 1);
 }
 
 /*
  * Description :
- * The function responsible for check if the two passwords are the same or not then respond to the HMI_ECU though the UART.
+ * The function responsible for check if the two passwords are the same or not.
  */
-uint8 checkSamePasswords(uint8 *password_1, uint8 *password_2)
+uint8 checkSamePasswords(const uint8 *password_1, const uint8 *password_2)
 {
 	uint8 i;
 	for(i = 0; i < PASSWORD_SIZE; i++)
@@ -251,172 +384,105 @@ uint8 checkSamePasswords(uint8 *password_1, uint8 *password_2)
 
 /*
  * Description :
- * The function responsible for saving the password in the EEPROM based on the address passed as a parameter.
+ * The function responsible for saving the password in the EEPROM through the RAM password cache,
+ * it is verified before the next password check.
  */
-void savePasswordInEEPROM(uint16 EEPROM_location, uint8 *password)
+uint8 savePasswordInEEPROM(const uint8 *password)
 {
-	uint8 i;
-	for(i = 0; i < PASSWORD_SIZE; i++)
-	{
-		EEPROM_writeByte(EEPROM_location, password[i]);
-		EEPROM_location += 1;
-		_delay_ms(10);
-	}
+	/* Queued for one EEPROM page write then read back by the next check */
+	return CREDENTIAL_save(password);
 }
 
 /*
  * Description :
- * The function responsible for receiving the password from the HMI_ECU through the UART.
+ * The function responsible for checking if the password matches the saved one or not,
+ * it is checked against the RAM password cache without reading the EEPROM.
  */
-void receivePasswordFrom_HMI_ECU(uint8 *password)
+uint8 checkOnPassword(const uint8 *HMI_password)
 {
-	uint8 i;
-	for(i = 0; i < PASSWORD_SIZE; i++)
+	if(CREDENTIAL_check(HMI_password) == TRUE)
 	{
-		UART_sendByte(MC2_READY);
-		password[i] = UART_recieveByte();
+		return MATCHED;
 	}
+	return NOT_MATCHED;
 }
 
 /*
  * Description :
- * The function responsible for checking if the password matches the one saved in the EEPROM or not
- * then responds to the HMI_ECU through the UART.
+ * The function responsible for rotating the DC-Motor clockwise for 15-seconds
+ * then holding it for 3-seconds then rotating the DC-Motor anti-clockwise.
+ * The steps are run in the background by the sequence engine.
  */
-uint8 checkOnPassword(uint16 EEPROM_location, uint8 *HMI_password)
+void APP_DcMotor(void)
 {
-	uint8 i;
-	uint8 savedPassword[5];
-
-	for(i = 0; i < PASSWORD_SIZE; i++)
-	{
-		EEPROM_readByte(EEPROM_location, savedPassword+i);
-		EEPROM_location += 1;
-	}
-
-	for(i = 0; i < PASSWORD_SIZE; i++)
-	{
-		if(HMI_password[i] != savedPassword[i])
-		{
-			return NOT_MATCHED;
-		}
-	}
-	return MATCHED;
+	SEQUENCE_start(&g_doorSequence, g_doorSteps, sizeof(g_doorSteps) / sizeof(g_doorSteps[0]), NULL_PTR);
 }
 
 /*
  * Description :
- * The function responsible for starting Timer1 based on the configurations passed as parameters
- * and pass the address of the call-back function.
+ * The function responsible for activation the buzzer for 1-minute.
+ * The steps are run in the background by the sequence engine.
  */
-void startTimer1(uint16 TCNT_value, uint16 OCR_value, Timer1_Prescaler prescaler, Timer1_Mode mode, void(*callBackFunctionAddress)(void))
+void APP_buzzer(void)
 {
-	Timer1_ConfigType Timer1_Configuration;
-
-	Timer1_Configuration.initial_value = TCNT_value;
-	Timer1_Configuration.compare_value = OCR_value; // 62500 = 8 seconds //54687 == 7 seconds
-	Timer1_Configuration.prescaler = prescaler;
-	Timer1_Configuration.mode = mode;
-
-	Timer1_setCallBack(callBackFunctionAddress);
-	Timer1_init(&Timer1_Configuration);
+	SEQUENCE_start(&g_alarmSequence, g_alarmSteps, sizeof(g_alarmSteps) / sizeof(g_alarmSteps[0]), APP_alarmFinished);
 }
 
 /*
  * Description :
- * The function responsible for rotating the DC-Motor clockwise for 15-seconds
- * then holding it for 3-seconds then rotating the DC-Motor anti-clockwise.
+ * Step action of the door sequence, it rotates the DC-Motor in the required direction.
  */
-void APP_DcMotor(void)
+void APP_rotateDoor(uint8 direction)
 {
-	g_ticks_DCMotor++;
+	DcMotor_Rotate((DcMotor_State)direction, 100);
+}
 
-	if(g_ticks_DCMotor == 1)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_DcMotor);  // 62500 = 8 seconds
-		DcMotor_Rotate(CLOCKWISE, 100);
-	}
-	else if(g_ticks_DCMotor == 2)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 54687, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_DcMotor);  //54687 == 7 seconds
-	}
-	else if(g_ticks_DCMotor == 3)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 23437, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_DcMotor);  //23437 == 3 seconds
-		DcMotor_Rotate(STOP, 100);
-	}
-	else if(g_ticks_DCMotor == 4)
+/*
+ * Description :
+ * Step action of the alarm sequence, it turns the buzzer on (LOGIC_HIGH) or off (LOGIC_LOW).
+ */
+void APP_setBuzzer(uint8 state)
+{
+	if(state == LOGIC_HIGH)
 	{
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_DcMotor);  // 62500 = 8 seconds
-		DcMotor_Rotate(ANTI_CLOCKWISE, 100);
+		Buzzer_on();
 	}
-	else if(g_ticks_DCMotor == 5)
+	else
 	{
-		Timer1_deInit();
-		startTimer1(0x00, 54687, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_DcMotor);  //54687 == 7 seconds
+		Buzzer_off();
 	}
-	else if(g_ticks_DCMotor == 6)
+}
+
+/*
+ * Description :
+ * The function called at the end of the alarm sequence, the password can be checked again.
+ * An aborted alarm did not run its last step so the buzzer is turned off here.
+ */
+void APP_alarmFinished(SEQUENCE_Type *sequence)
+{
+	if(sequence->state != SEQUENCE_FINISHED)
 	{
-		DcMotor_Rotate(STOP, 100);
-		Timer1_deInit();
+		Buzzer_off();
 	}
+
+	g_wrongPasswordCounter = 0;
 }
 
+#ifdef TWI_SELF_TEST
 /*
  * Description :
- * The function responsible for activation the buzzer for 1-minute.
+ * The function responsible for measuring the EEPROM throughput at 100 kHz and TWI_SCL_FREQUENCY
+ * then running the bus at the faster frequency which passes.
  */
-void APP_buzzer(void)
+void selfTestTWI(void)
 {
-	g_ticks_buzzer++;
+	uint8 standardResult = EEPROM_selfTest(TWI_SCL_100KHZ, &g_twiSelfTest[0]);
+	uint8 fastResult = EEPROM_selfTest(TWI_SCL_FREQUENCY, &g_twiSelfTest[1]);
 
-	if(g_ticks_buzzer == 1)
-	{
-		Buzzer_on();
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 2)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 3)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 4)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 5)
+	/* The bus is left at TWI_SCL_FREQUENCY by the last test */
+	if((fastResult != SUCCESS) && (standardResult == SUCCESS))
 	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 6)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 7)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_buzzer == 8)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 3125, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_buzzer);  // 3125 = 4 seconds
-	}
-	else if(g_ticks_buzzer == 9)
-	{
-		Buzzer_off();
+		TWI_setBitRate(TWI_SCL_100KHZ);
 	}
 }
-
+#endif
@@ -0,0 +1,348 @@
+ /******************************************************************************
+ *
+ * Module: Credential
+ *
+ * File Name: credential.c
+ *
+ * Description: Source file for the door password store, a wear leveled log of password
+ * records in the external EEPROM with a RAM copy of the newest one
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include "credential.h"
+#include "external_eeprom.h"
+#include "crc16.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Record fields offsets */
+#define CREDENTIAL_SEQUENCE_INDEX      0
+#define CREDENTIAL_PASSWORD_INDEX      1
+#define CREDENTIAL_CRC_INDEX           (CREDENTIAL_PASSWORD_INDEX + CREDENTIAL_PASSWORD_SIZE)
+
+#if((CREDENTIAL_CRC_INDEX + 2) > CREDENTIAL_RECORD_SIZE)
+
+#error "The password record does not fit in CREDENTIAL_RECORD_SIZE"
+
+#endif
+
+#if((CREDENTIAL_SCAN_CHUNK_SIZE % CREDENTIAL_RECORD_SIZE) != 0) || ((CREDENTIAL_LOG_SIZE % CREDENTIAL_SCAN_CHUNK_SIZE) != 0)
+
+#error "The scan chunk should hold whole records and divide the password log"
+
+#endif
+
+#if((CREDENTIAL_LOG_ADDRESS + CREDENTIAL_LOG_SIZE) > EEPROM_SIZE)
+
+#error "The password log is outside the EEPROM"
+
+#endif
+
+/* Each record is saved by one page write so the records must not cross an EEPROM page end */
+#if((CREDENTIAL_LOG_ADDRESS % EEPROM_PAGE_SIZE) != 0) || ((EEPROM_PAGE_SIZE % CREDENTIAL_RECORD_SIZE) != 0)
+
+#error "The password records should be aligned on the EEPROM pages"
+
+#endif
+
+/*
+ * The sequence numbers of the records in the log are always inside a window of CREDENTIAL_RECORDS_COUNT
+ * numbers, the 8-bit sequence numbers are compared over the wrap around only if the window is less than 128.
+ */
+#if(CREDENTIAL_RECORDS_COUNT > 127)
+
+#error "Too many password records for the 8-bit sequence number"
+
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* RAM copy of the saved password, used only while g_cacheValid is TRUE */
+static uint8 g_cachedPassword[CREDENTIAL_PASSWORD_SIZE];
+static boolean g_cacheValid = FALSE;
+
+/* Newest record found by the last scan or save, the next save is written in the record after it */
+static uint8 g_newestRecord = CREDENTIAL_RECORDS_COUNT - 1;
+static uint8 g_newestSequence = 0xFF;
+
+/* Copy of the last saved record, kept for the read back after it is written in the background */
+static uint8 g_pendingRecord[CREDENTIAL_RECORD_SIZE];
+static boolean g_savePending = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Check if two buffers are the same.
+ */
+static boolean CREDENTIAL_isSame(const uint8 *buffer_1, const uint8 *buffer_2, uint8 length);
+
+/*
+ * Description :
+ * Check the CRC of a record and that its password has only keypad digits,
+ * an erased record (0xFF) or a record broken by a power loss is not valid.
+ */
+static boolean CREDENTIAL_isValidRecord(const uint8 *record);
+
+/*
+ * Description :
+ * Return the EEPROM address of the required record.
+ */
+static uint16 CREDENTIAL_recordAddress(uint8 index);
+
+/*
+ * Description :
+ * Fill a record with the required sequence number and password then its CRC.
+ */
+static void CREDENTIAL_buildRecord(uint8 *record, uint8 sequence, const uint8 *password);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read the log by sequential reads of CREDENTIAL_SCAN_CHUNK_SIZE bytes and load the password of its newest
+ * valid record into the RAM cache, the cache is valid only if such a record is found. Returns the cache validity.
+ */
+boolean CREDENTIAL_init(void)
+{
+	uint8 i;
+	uint8 j;
+	uint8 *record;
+	uint8 chunk[CREDENTIAL_SCAN_CHUNK_SIZE];
+
+	g_cacheValid = FALSE;
+
+	/* The scan reads what is really stored so a pending record is not verified separately */
+	g_savePending = FALSE;
+	EEPROM_flush();
+
+	/* With no valid record the log is started again from its first record */
+	g_newestRecord = CREDENTIAL_RECORDS_COUNT - 1;
+	g_newestSequence = 0xFF;
+
+	for(i = 0; i < CREDENTIAL_RECORDS_COUNT; i++)
+	{
+		/*
+		 * Each chunk is one sequential read of several records so the scan needs few transactions
+		 * without holding the whole log on the stack. A chunk which cannot be read may hide the newest
+		 * record so nothing is trusted.
+		 */
+		record = chunk + (((uint16)i * CREDENTIAL_RECORD_SIZE) % CREDENTIAL_SCAN_CHUNK_SIZE);
+		if((record == chunk) &&
+		   (EEPROM_readBlock(CREDENTIAL_recordAddress(i), chunk, CREDENTIAL_SCAN_CHUNK_SIZE) != SUCCESS))
+		{
+			g_cacheValid = FALSE;
+			g_newestRecord = CREDENTIAL_RECORDS_COUNT - 1;
+			g_newestSequence = 0xFF;
+			return FALSE;
+		}
+
+		if(CREDENTIAL_isValidRecord(record) == FALSE)
+		{
+			continue;
+		}
+
+		/* Newer means a sequence number after the newest one over the 8-bit wrap around */
+		if((g_cacheValid == FALSE) || ((sint8)(record[CREDENTIAL_SEQUENCE_INDEX] - g_newestSequence) > 0))
+		{
+			g_newestRecord = i;
+			g_newestSequence = record[CREDENTIAL_SEQUENCE_INDEX];
+			for(j = 0; j < CREDENTIAL_PASSWORD_SIZE; j++)
+			{
+				g_cachedPassword[j] = record[CREDENTIAL_PASSWORD_INDEX + j];
+			}
+			g_cacheValid = TRUE;
+		}
+	}
+
+	return g_cacheValid;
+}
+
+/*
+ * Description :
+ * Check if the required password matches the saved one, the RAM cache is used so the EEPROM
+ * is read only if the cache is not valid or a saved record is not verified yet.
+ * A password which cannot be loaded never matches.
+ */
+boolean CREDENTIAL_check(const uint8 *password)
+{
+	/* A record which failed in the background must not be trusted */
+	CREDENTIAL_flush();
+
+	if((g_cacheValid == FALSE) && (CREDENTIAL_init() == FALSE))
+	{
+		return FALSE;
+	}
+
+	return CREDENTIAL_isSame(password, g_cachedPassword, CREDENTIAL_PASSWORD_SIZE);
+}
+
+/*
+ * Description :
+ * Append a new password record after the newest one, the oldest record is overwritten when the log is full.
+ * The record is written in the background by the EEPROM write-behind queue and the cache holds the new
+ * password at once, a save before the previous record is started replaces it in the queue.
+ * Returns SUCCESS or ERROR.
+ */
+uint8 CREDENTIAL_save(const uint8 *password)
+{
+	uint8 i;
+
+	for(i = 0; i < CREDENTIAL_PASSWORD_SIZE; i++)
+	{
+		g_cachedPassword[i] = password[i];
+	}
+
+	/*
+	 * A record still waiting in the write queue is replaced with the same sequence number, it is not
+	 * in the EEPROM yet so the previous record is still the one found after a power loss.
+	 */
+	if(g_savePending == TRUE)
+	{
+		CREDENTIAL_buildRecord(g_pendingRecord, g_newestSequence, password);
+		if(EEPROM_updateQueuedWrite(CREDENTIAL_recordAddress(g_newestRecord), g_pendingRecord, CREDENTIAL_RECORD_SIZE) == TRUE)
+		{
+			g_cacheValid = TRUE;
+			return SUCCESS;
+		}
+	}
+
+	/*
+	 * A stored record is never written again in place, the new one goes to the next record so the newest
+	 * stored record stays valid until the new one is complete (the commit is the write of one page).
+	 * The records are written in a ring so each one is rewritten once every CREDENTIAL_RECORDS_COUNT saves,
+	 * the overwritten record is always the oldest one and the stale records need no separate compaction.
+	 */
+	g_newestRecord = (uint8)((g_newestRecord + 1) % CREDENTIAL_RECORDS_COUNT);
+	g_newestSequence++;
+	CREDENTIAL_buildRecord(g_pendingRecord, g_newestSequence, password);
+
+	if(EEPROM_queueWrite(CREDENTIAL_recordAddress(g_newestRecord), g_pendingRecord, CREDENTIAL_RECORD_SIZE) != SUCCESS)
+	{
+		g_savePending = FALSE;
+		g_cacheValid = FALSE;
+		return ERROR;
+	}
+
+	g_savePending = TRUE;
+	g_cacheValid = TRUE;
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Wait until the last saved record is stored then read it back to verify it.
+ * The cache is invalidated if the record is not stored correctly so the next check scans the log again.
+ * Returns SUCCESS or ERROR.
+ */
+uint8 CREDENTIAL_flush(void)
+{
+	uint8 savedRecord[CREDENTIAL_RECORD_SIZE];
+
+	if(g_savePending == FALSE)
+	{
+		return SUCCESS;
+	}
+	g_savePending = FALSE;
+
+	if((EEPROM_flush() != SUCCESS) ||
+	   (EEPROM_readBlock(CREDENTIAL_recordAddress(g_newestRecord), savedRecord, CREDENTIAL_RECORD_SIZE) != SUCCESS) ||
+	   (CREDENTIAL_isSame(g_pendingRecord, savedRecord, CREDENTIAL_RECORD_SIZE) == FALSE))
+	{
+		g_cacheValid = FALSE;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/*
+ * Description :
+ * Check if two buffers are the same.
+ */
+static boolean CREDENTIAL_isSame(const uint8 *buffer_1, const uint8 *buffer_2, uint8 length)
+{
+	uint8 i;
+
+	for(i = 0; i < length; i++)
+	{
+		if(buffer_1[i] != buffer_2[i])
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Check the CRC of a record and that its password has only keypad digits,
+ * an erased record (0xFF) or a record broken by a power loss is not valid.
+ */
+static boolean CREDENTIAL_isValidRecord(const uint8 *record)
+{
+	uint8 i;
+	uint16 crc = CRC16_update(CRC16_INITIAL_VALUE, record, CREDENTIAL_CRC_INDEX);
+
+	if((record[CREDENTIAL_CRC_INDEX] != (uint8)(crc >> 8)) || (record[CREDENTIAL_CRC_INDEX + 1] != (uint8)crc))
+	{
+		return FALSE;
+	}
+
+	for(i = 0; i < CREDENTIAL_PASSWORD_SIZE; i++)
+	{
+		if(record[CREDENTIAL_PASSWORD_INDEX + i] > CREDENTIAL_MAX_DIGIT)
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return the EEPROM address of the required record.
+ */
+static uint16 CREDENTIAL_recordAddress(uint8 index)
+{
+	return CREDENTIAL_LOG_ADDRESS + ((uint16)index * CREDENTIAL_RECORD_SIZE);
+}
+
+/*
+ * Description :
+ * Fill a record with the required sequence number and password then its CRC.
+ */
+static void CREDENTIAL_buildRecord(uint8 *record, uint8 sequence, const uint8 *password)
+{
+	uint8 i;
+	uint16 crc;
+
+	record[CREDENTIAL_SEQUENCE_INDEX] = sequence;
+	for(i = 0; i < CREDENTIAL_PASSWORD_SIZE; i++)
+	{
+		record[CREDENTIAL_PASSWORD_INDEX + i] = password[i];
+	}
+
+	/* The CRC covers the sequence number and the password, a record torn by a power loss does not match it */
+	crc = CRC16_update(CRC16_INITIAL_VALUE, record, CREDENTIAL_CRC_INDEX);
+	record[CREDENTIAL_CRC_INDEX] = (uint8)(crc >> 8);
+	record[CREDENTIAL_CRC_INDEX + 1] = (uint8)crc;
+
+	for(i = CREDENTIAL_CRC_INDEX + 2; i < CREDENTIAL_RECORD_SIZE; i++)
+	{
+		record[i] = 0xFF;
+	}
+}
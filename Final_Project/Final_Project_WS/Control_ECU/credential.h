@@ -0,0 +1,81 @@
+ /******************************************************************************
+ *
+ * Module: Credential
+ *
+ * File Name: credential.h
+ *
+ * Description: Header file for the door password store, a wear leveled log of password
+ * records in the external EEPROM with a RAM copy of the newest one
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef CREDENTIAL_H_
+#define CREDENTIAL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* The password is 5 keypad digits (0 to 9) */
+#define CREDENTIAL_PASSWORD_SIZE       5
+#define CREDENTIAL_MAX_DIGIT           9
+
+/*
+ * The password is not rewritten in place, each save appends a new record to a ring of records
+ * in this EEPROM area so the writes are spread over all its pages (16 pages of 2 records each).
+ * Record: | SEQUENCE | PASSWORD (5 bytes) | CRC hi | CRC lo |
+ * The valid record with the newest sequence number is the saved password. A new record never overwrites
+ * the newest one so it is always there if the power is lost during a save (like A/B slots with more slots).
+ */
+#define CREDENTIAL_LOG_ADDRESS         0x0300
+#define CREDENTIAL_LOG_SIZE            256
+#define CREDENTIAL_RECORD_SIZE         8
+#define CREDENTIAL_RECORDS_COUNT       (CREDENTIAL_LOG_SIZE / CREDENTIAL_RECORD_SIZE)
+
+/*
+ * The boot scan reads the log in chunks of this size (8 sequential reads for 32 bytes) instead of one
+ * read of the whole log, the chunk buffer is on the stack so it is kept small.
+ */
+#define CREDENTIAL_SCAN_CHUNK_SIZE     32
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read the log by sequential reads of CREDENTIAL_SCAN_CHUNK_SIZE bytes and load the password of its newest
+ * valid record into the RAM cache, the cache is valid only if such a record is found. Returns the cache validity.
+ */
+boolean CREDENTIAL_init(void);
+
+/*
+ * Description :
+ * Check if the required password matches the saved one, the RAM cache is used so the EEPROM
+ * is read only if the cache is not valid or a saved record is not verified yet.
+ * A password which cannot be loaded never matches.
+ */
+boolean CREDENTIAL_check(const uint8 *password);
+
+/*
+ * Description :
+ * Append a new password record after the newest one, the oldest record is overwritten when the log is full.
+ * The record is written in the background by the EEPROM write-behind queue and the cache holds the new
+ * password at once, a save before the previous record is started replaces it in the queue.
+ * Returns SUCCESS or ERROR.
+ */
+uint8 CREDENTIAL_save(const uint8 *password);
+
+/*
+ * Description :
+ * Wait until the last saved record is stored then read it back to verify it.
+ * The cache is invalidated if the record is not stored correctly so the next check scans the log again.
+ * Returns SUCCESS or ERROR.
+ */
+uint8 CREDENTIAL_flush(void);
+
+#endif /* CREDENTIAL_H_ */
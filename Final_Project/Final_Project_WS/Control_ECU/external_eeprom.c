@@ -11,72 +11,562 @@
  *******************************************************************************/
 #include "external_eeprom.h"
 #include "twi.h"
+#include "timer2.h" /* For the write cycle timeout and time */
+#include <avr/io.h>
+#include <avr/interrupt.h>
 
-uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+/* The self-test area must be inside the memory */
+#if((EEPROM_SELF_TEST_ADDRESS + EEPROM_SELF_TEST_SIZE) > EEPROM_SIZE)
+
+#error "The self-test area is outside the EEPROM"
+
+#endif
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* One write waiting in the write-behind queue */
+typedef struct
 {
-	/* Send the Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR; 
-		 
-    /* Send the required memory location address */
-    TWI_writeByte((uint8)(u16addr));
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
+    EEPROM_AddressType address;
+    uint8 length;
+    uint8 data[EEPROM_PAGE_SIZE];
+} EEPROM_QueuedWriteType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Write-behind queue, the head is the write in progress while g_queueRunning is TRUE */
+static EEPROM_QueuedWriteType g_writeQueue[EEPROM_WRITE_QUEUE_SIZE];
+static volatile uint8 g_writeQueueHead = 0;
+static volatile uint8 g_writeQueueCount = 0;
+static volatile boolean g_queueRunning = FALSE;
+static volatile uint8 g_queueResult = SUCCESS;
+static TWI_TransactionType g_queueTransaction;
+
+/* The address only transaction used to poll the EEPROM during its write cycle */
+static TWI_TransactionType g_pollTransaction;
+static uint8 g_pollDeviceAddress = EEPROM_BASE_DEVICE_ADDRESS;
+static void (*g_readyCallBack)(uint8 result) = NULL_PTR;
+static volatile boolean g_polling = FALSE;
+static volatile uint8 g_pollResult;
+static uint16 g_pollStartTick;
+
+/* The end of the last write transaction in TIMER2_FINE_TICK_US units and the measured write cycle */
+static uint16 g_writeCycleStart;
+static volatile uint16 g_writeCycleTime = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Call-back of the polling transaction, it polls again while the EEPROM is busy.
+ */
+static void EEPROM_pollCallBack(TWI_TransactionType *transaction);
+
+/*
+ * Description :
+ * Run a blocking transaction, it is run again after a bus error or a timeout (the bus is recovered)
+ * up to EEPROM_TRANSACTION_RETRIES times. A NACK is not retried, the EEPROM answered.
+ */
+static uint8 EEPROM_runTransaction(TWI_TransactionType *transaction);
+
+/*
+ * Description :
+ * Set the device address and the word address of a transaction from a memory address,
+ * the chip written by it is the one polled by EEPROM_notifyReady.
+ */
+static void EEPROM_setAddress(TWI_TransactionType *transaction, EEPROM_AddressType address);
+
+/*
+ * Description :
+ * Start writing the write at the head of the queue, it is called with the interrupts disabled, from the TWI ISR
+ * or from a call-back function of a timed out transaction (the TWI ISR cannot run then).
+ */
+static void EEPROM_startQueuedWrite(void);
+
+/*
+ * Description :
+ * Call-back of the queued write transaction, it polls the EEPROM until its write cycle is finished.
+ */
+static void EEPROM_queueWriteCallBack(TWI_TransactionType *transaction);
+
+/*
+ * Description :
+ * Call-back of the polling after a queued write, it removes the write from the queue and starts the next one.
+ */
+static void EEPROM_queueReadyCallBack(uint8 result);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+
+uint8 EEPROM_writeByte(EEPROM_AddressType address, uint8 u8data)
+{
+    TWI_TransactionType transaction;
+
+    /* The EEPROM does not answer during the write cycles of the queued writes */
+    while (g_writeQueueCount > 0)
+        TWI_checkTimeout();
+
+    /* The memory location address followed by the data byte in one write transaction */
+    EEPROM_setAddress(&transaction, address);
+    transaction.writeData = &u8data;
+    transaction.writeLength = 1;
+    transaction.readData = NULL_PTR;
+    transaction.readLength = 0;
+    transaction.callBack = NULL_PTR;
+
+    /* The bytes are sent by the TWI interrupt, the queued transactions are finished first */
+    if (EEPROM_runTransaction(&transaction) != SUCCESS)
         return ERROR;
-		
-    /* write byte to eeprom */
-    TWI_writeByte(u8data);
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
+    g_writeCycleStart = Timer2_getFineTicks();
+
+    return EEPROM_waitReady();
+}
+
+uint8 EEPROM_readByte(EEPROM_AddressType address, uint8 *u8data)
+{
+    TWI_TransactionType transaction;
+
+    /* The EEPROM does not answer during the write cycles of the queued writes */
+    while (g_writeQueueCount > 0)
+        TWI_checkTimeout();
+
+    /* Write the memory location address then a repeated start to read one byte with NACK */
+    EEPROM_setAddress(&transaction, address);
+    transaction.writeData = NULL_PTR;
+    transaction.writeLength = 0;
+    transaction.readData = u8data;
+    transaction.readLength = 1;
+    transaction.callBack = NULL_PTR;
+
+    if (EEPROM_runTransaction(&transaction) != SUCCESS)
         return ERROR;
 
-    /* Send the Stop Bit */
-    TWI_stop();
-	
     return SUCCESS;
 }
 
-uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
+/*
+ * Description :
+ * Write a block of bytes starting at the required address. The block is split on the page ends
+ * and each part is written by one transaction followed by one write cycle.
+ */
+uint8 EEPROM_writeBlock(EEPROM_AddressType address, const uint8 *data, uint16 length)
 {
-	/* Send the Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR;
-		
-    /* Send the required memory location address */
-    TWI_writeByte((uint8)(u16addr));
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
-        return ERROR;
-		
-    /* Send the Repeated Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_REP_START)
+    uint8 pageLength;
+    TWI_TransactionType transaction;
+
+    /* The EEPROM does not answer during the write cycles of the queued writes */
+    while (g_writeQueueCount > 0)
+        TWI_checkTimeout();
+
+    while (length > 0)
+    {
+        /* Bytes left from the address to the end of its page */
+        pageLength = EEPROM_PAGE_SIZE - (address & (EEPROM_PAGE_SIZE - 1));
+        if (pageLength > length)
+            pageLength = length;
+
+        EEPROM_setAddress(&transaction, address);
+        transaction.writeData = data;
+        transaction.writeLength = pageLength;
+        transaction.readData = NULL_PTR;
+        transaction.readLength = 0;
+        transaction.callBack = NULL_PTR;
+
+        if (EEPROM_runTransaction(&transaction) != SUCCESS)
+            return ERROR;
+        g_writeCycleStart = Timer2_getFineTicks();
+
+        /* The EEPROM does not answer until the page is stored */
+        if (EEPROM_waitReady() != SUCCESS)
+            return ERROR;
+
+        address += pageLength;
+        data += pageLength;
+        length -= pageLength;
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * Description :
+ * Read a block of bytes starting at the required address by sequential reads, the memory address
+ * is sent once then the bytes are read with ACK and the last one with NACK.
+ */
+uint8 EEPROM_readBlock(EEPROM_AddressType address, uint8 *data, uint16 length)
+{
+    uint8 partLength;
+    TWI_TransactionType transaction;
+
+    /* The EEPROM does not answer during the write cycles of the queued writes */
+    while (g_writeQueueCount > 0)
+        TWI_checkTimeout();
+
+    /* The internal address counter goes over the pages but not to the next device address */
+    while (length > 0)
+    {
+        partLength = (length > 0xFF) ? 0xFF : (uint8)length;
+        if (partLength > (EEPROM_DEVICE_SPAN - (address % EEPROM_DEVICE_SPAN)))
+            partLength = (uint8)(EEPROM_DEVICE_SPAN - (address % EEPROM_DEVICE_SPAN));
+
+        EEPROM_setAddress(&transaction, address);
+        transaction.writeData = NULL_PTR;
+        transaction.writeLength = 0;
+        transaction.readData = data;
+        transaction.readLength = partLength;
+        transaction.callBack = NULL_PTR;
+
+        if (EEPROM_runTransaction(&transaction) != SUCCESS)
+            return ERROR;
+
+        address += partLength;
+        data += partLength;
+        length -= partLength;
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * Description :
+ * Poll the EEPROM until it finishes its write cycle. Returns ERROR if it does not answer in time.
+ */
+uint8 EEPROM_waitReady(void)
+{
+    EEPROM_notifyReady(NULL_PTR);
+    while (g_polling)
+        TWI_checkTimeout();
+
+    return g_pollResult;
+}
+
+/*
+ * Description :
+ * Start polling the EEPROM chip of the last transaction in the background, the call-back function is called from the TWI ISR
+ * with SUCCESS when the write cycle is finished or ERROR if it does not answer in time.
+ * Only one polling can run at the same time.
+ */
+void EEPROM_notifyReady(void (*callBack)(uint8 result))
+{
+    g_readyCallBack = callBack;
+    g_polling = TRUE;
+    g_pollStartTick = Timer2_getTicks();
+
+    /* Only START + SLA+W + STOP, the EEPROM answers its address with ACK when it is ready */
+    g_pollTransaction.slaveAddress = g_pollDeviceAddress;
+    g_pollTransaction.memoryAddressLength = 0;
+    g_pollTransaction.writeData = NULL_PTR;
+    g_pollTransaction.writeLength = 0;
+    g_pollTransaction.readData = NULL_PTR;
+    g_pollTransaction.readLength = 0;
+    g_pollTransaction.callBack = EEPROM_pollCallBack;
+
+    TWI_submitTransaction(&g_pollTransaction);
+}
+
+/*
+ * Description :
+ * Return the measured time of the last write cycle in microseconds.
+ */
+uint16 EEPROM_getWriteCycleTime(void)
+{
+    return g_writeCycleTime;
+}
+
+/*
+ * Description :
+ * Call-back of the polling transaction, it polls again while the EEPROM is busy.
+ */
+static void EEPROM_pollCallBack(TWI_TransactionType *transaction)
+{
+    if ((transaction->status == TWI_TRANSACTION_ADDRESS_NACK) &&
+            !Timer2_isElapsed(g_pollStartTick, EEPROM_WRITE_CYCLE_TIMEOUT_MS))
+    {
+        /* Still busy, it is started again as soon as this transaction is stopped */
+        TWI_submitTransaction(transaction);
+        return;
+    }
+
+    if (transaction->status == TWI_TRANSACTION_DONE)
+    {
+        g_pollResult = SUCCESS;
+        g_writeCycleTime = (uint16)(Timer2_getFineTicks() - g_writeCycleStart) * TIMER2_FINE_TICK_US;
+    }
+    else
+    {
+        g_pollResult = ERROR;
+    }
+
+    g_polling = FALSE;
+    if (g_readyCallBack != NULL_PTR)
+    {
+        (*g_readyCallBack)(g_pollResult);
+    }
+}
+
+/*
+ * Description :
+ * Queue a write of up to one page which must not cross the page end, the data is copied and written
+ * in the background by the TWI ISR so the function returns before the write cycle is finished.
+ * A queued write to the same address and length which is not started yet is replaced by the new data.
+ * It waits only if the queue is full. Returns ERROR if the write does not fit in one page.
+ * The blocking read and write functions wait for the queue to be empty first.
+ */
+uint8 EEPROM_queueWrite(EEPROM_AddressType address, const uint8 *data, uint8 length)
+{
+    uint8 i;
+    uint8 sreg;
+    EEPROM_QueuedWriteType *entry;
+
+    if ((length == 0) || (((address & (EEPROM_PAGE_SIZE - 1)) + length) > EEPROM_PAGE_SIZE))
         return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=1 (Read) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
-    if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
+
+    /* A waiting write to the same data is replaced so only one write cycle is spent */
+    if (EEPROM_updateQueuedWrite(address, data, length) == TRUE)
+        return SUCCESS;
+
+    while (g_writeQueueCount == EEPROM_WRITE_QUEUE_SIZE)
+        TWI_checkTimeout();
+
+    /* The queue is changed by the TWI ISR too */
+    sreg = SREG;
+    cli();
+
+    entry = &g_writeQueue[(g_writeQueueHead + g_writeQueueCount) % EEPROM_WRITE_QUEUE_SIZE];
+    entry->address = address;
+    entry->length = length;
+    for (i = 0; i < length; i++)
+    {
+        entry->data[i] = data[i];
+    }
+    g_writeQueueCount++;
+
+    if (g_queueRunning == FALSE)
+    {
+        EEPROM_startQueuedWrite();
+    }
+    SREG = sreg;
+
+    return SUCCESS;
+}
+
+/*
+ * Description :
+ * Replace the data of a queued write to the same address and length which is not started yet.
+ * Returns FALSE if there is no such write, a write which is already on the bus is never changed.
+ */
+boolean EEPROM_updateQueuedWrite(EEPROM_AddressType address, const uint8 *data, uint8 length)
+{
+    uint8 i;
+    uint8 j;
+    uint8 sreg = SREG;
+    EEPROM_QueuedWriteType *entry;
+
+    /* The ISR must not start the write while its data is changed */
+    cli();
+    for (i = (g_queueRunning ? 1 : 0); i < g_writeQueueCount; i++)
+    {
+        entry = &g_writeQueue[(g_writeQueueHead + i) % EEPROM_WRITE_QUEUE_SIZE];
+        if ((entry->address == address) && (entry->length == length))
+        {
+            for (j = 0; j < length; j++)
+            {
+                entry->data[j] = data[j];
+            }
+            SREG = sreg;
+            return TRUE;
+        }
+    }
+    SREG = sreg;
+
+    return FALSE;
+}
+
+/*
+ * Description :
+ * Wait until all the queued writes are stored (a barrier for the write-behind queue).
+ * Returns ERROR if any queued write failed since the last flush.
+ */
+uint8 EEPROM_flush(void)
+{
+    uint8 result;
+
+    while (g_writeQueueCount > 0)
+        TWI_checkTimeout();
+
+    result = g_queueResult;
+    g_queueResult = SUCCESS;
+
+    return result;
+}
+
+/*
+ * Description :
+ * Measure the real write and read throughput at the required SCL frequency: the self-test area is written
+ * by page writes then read back by a sequential read and compared, each one is timed with the Timer2 tick.
+ * The bus is left at the tested frequency. Returns ERROR if any transfer fails or the data read back is wrong.
+ * It spends one write cycle of each page of the self-test area so it is not meant for every boot.
+ */
+uint8 EEPROM_selfTest(uint32 scl_hz, EEPROM_SelfTestType *result)
+{
+    uint8 i;
+    uint16 start;
+    uint16 time;
+    uint8 data[EEPROM_SELF_TEST_SIZE];
+
+    /* The bit rate must not change under a queued write */
+    while ((g_writeQueueCount > 0) || !TWI_isIdle())
+        TWI_checkTimeout();
+
+    result->sclHz = TWI_setBitRate(scl_hz);
+    result->writeBytesPerSecond = 0;
+    result->readBytesPerSecond = 0;
+
+    for (i = 0; i < EEPROM_SELF_TEST_SIZE; i++)
+    {
+        data[i] = (uint8)(i ^ 0xA5);
+    }
+
+    /* The times are in TIMER2_FINE_TICK_US units, both transfers are far shorter than the wrap around */
+    start = Timer2_getFineTicks();
+    if (EEPROM_writeBlock(EEPROM_SELF_TEST_ADDRESS, data, EEPROM_SELF_TEST_SIZE) != SUCCESS)
         return ERROR;
+    time = (uint16)(Timer2_getFineTicks() - start);
+    result->writeBytesPerSecond = (EEPROM_SELF_TEST_SIZE * (1000000UL / TIMER2_FINE_TICK_US)) / (time ? time : 1);
+
+    for (i = 0; i < EEPROM_SELF_TEST_SIZE; i++)
+    {
+        data[i] = 0;
+    }
 
-    /* Read Byte from Memory without send ACK */
-    *u8data = TWI_readByteWithNACK();
-    if (TWI_getStatus() != TWI_MR_DATA_NACK)
+    start = Timer2_getFineTicks();
+    if (EEPROM_readBlock(EEPROM_SELF_TEST_ADDRESS, data, EEPROM_SELF_TEST_SIZE) != SUCCESS)
         return ERROR;
+    time = (uint16)(Timer2_getFineTicks() - start);
+    result->readBytesPerSecond = (EEPROM_SELF_TEST_SIZE * (1000000UL / TIMER2_FINE_TICK_US)) / (time ? time : 1);
 
-    /* Send the Stop Bit */
-    TWI_stop();
+    for (i = 0; i < EEPROM_SELF_TEST_SIZE; i++)
+    {
+        if (data[i] != (uint8)(i ^ 0xA5))
+            return ERROR;
+    }
 
     return SUCCESS;
 }
+
+/*
+ * Description :
+ * Start writing the write at the head of the queue, it is called with the interrupts disabled, from the TWI ISR
+ * or from a call-back function of a timed out transaction (the TWI ISR cannot run then).
+ */
+static void EEPROM_startQueuedWrite(void)
+{
+    EEPROM_QueuedWriteType *entry = &g_writeQueue[g_writeQueueHead];
+
+    g_queueRunning = TRUE;
+
+    EEPROM_setAddress(&g_queueTransaction, entry->address);
+    g_queueTransaction.writeData = entry->data;
+    g_queueTransaction.writeLength = entry->length;
+    g_queueTransaction.readData = NULL_PTR;
+    g_queueTransaction.readLength = 0;
+    g_queueTransaction.callBack = EEPROM_queueWriteCallBack;
+
+    TWI_submitTransaction(&g_queueTransaction);
+}
+
+/*
+ * Description :
+ * Call-back of the queued write transaction, it polls the EEPROM until its write cycle is finished.
+ */
+static void EEPROM_queueWriteCallBack(TWI_TransactionType *transaction)
+{
+    if (transaction->status != TWI_TRANSACTION_DONE)
+    {
+        EEPROM_queueReadyCallBack(ERROR);
+        return;
+    }
+
+    g_writeCycleStart = Timer2_getFineTicks();
+    EEPROM_notifyReady(EEPROM_queueReadyCallBack);
+}
+
+/*
+ * Description :
+ * Call-back of the polling after a queued write, it removes the write from the queue and starts the next one.
+ */
+static void EEPROM_queueReadyCallBack(uint8 result)
+{
+    if (result != SUCCESS)
+    {
+        g_queueResult = ERROR;
+    }
+
+    g_writeQueueHead = (uint8)((g_writeQueueHead + 1) % EEPROM_WRITE_QUEUE_SIZE);
+    g_writeQueueCount--;
+
+    if (g_writeQueueCount > 0)
+    {
+        EEPROM_startQueuedWrite();
+    }
+    else
+    {
+        g_queueRunning = FALSE;
+    }
+}
+
+/*
+ * Description :
+ * Run a blocking transaction, it is run again after a bus error or a timeout (the bus is recovered)
+ * up to EEPROM_TRANSACTION_RETRIES times. A NACK is not retried, the EEPROM answered.
+ */
+static uint8 EEPROM_runTransaction(TWI_TransactionType *transaction)
+{
+    uint8 retries = 0;
+    TWI_TransactionStatus status;
+
+    while (1)
+    {
+        TWI_submitTransaction(transaction);
+        status = TWI_waitTransaction(transaction);
+
+        if (status == TWI_TRANSACTION_DONE)
+            return SUCCESS;
+
+        if (((status != TWI_TRANSACTION_BUS_ERROR) && (status != TWI_TRANSACTION_TIMEOUT)) ||
+                (retries >= EEPROM_TRANSACTION_RETRIES))
+            return ERROR;
+
+        retries++;
+    }
+}
+
+/*
+ * Description :
+ * Set the device address and the word address of a transaction from a memory address,
+ * the chip written by it is the one polled by EEPROM_notifyReady.
+ */
+static void EEPROM_setAddress(TWI_TransactionType *transaction, EEPROM_AddressType address)
+{
+    transaction->slaveAddress = EEPROM_DEVICE_ADDRESS(address);
+    g_pollDeviceAddress = transaction->slaveAddress;
+
+#if(EEPROM_ADDRESS_SIZE == 2)
+    /* The word address inside the chip, high byte first */
+    transaction->memoryAddress[0] = (uint8)((address % EEPROM_DEVICE_SPAN) >> 8);
+    transaction->memoryAddress[1] = (uint8)(address);
+    transaction->memoryAddressLength = 2;
+#else
+    /* The upper address bits are in the device address */
+    transaction->memoryAddress[0] = (uint8)(address);
+    transaction->memoryAddressLength = 1;
+#endif
+}
@@ -22,11 +22,183 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/*
+ * EEPROM device description, the programmer sets it for the connected part:
+ * EEPROM_CHIP_SIZE    : bytes in one chip.
+ * EEPROM_PAGE_SIZE    : bytes of one page write, the bytes of one write transaction are stored together
+ *                       in one write cycle but they must not cross a page end (the address wraps around
+ *                       to the start of the page).
+ * EEPROM_ADDRESS_SIZE : bytes of the word address sent after the device address.
+ * EEPROM_CHIPS_COUNT  : chips on the bus with the chip select pins (A2 A1 A0) 0, 1, 2 ... they are used
+ *                       as one memory, the next chip starts after the end of the previous one.
+ *
+ *   Part     EEPROM_CHIP_SIZE   EEPROM_PAGE_SIZE   EEPROM_ADDRESS_SIZE   max EEPROM_CHIPS_COUNT
+ *   24C02         256                  8                  1                     8
+ *   24C04         512                 16                  1                     4
+ *   24C08        1024                 16                  1                     2
+ *   24C16        2048                 16                  1                     1
+ *   24C32        4096                 32                  2                     8
+ *   24C64        8192                 32                  2                     8
+ *   24C128      16384                 64                  2                     8
+ *   24C256      32768                 64                  2                     8
+ *   24C512      65536                128                  2                     8
+ */
+#define EEPROM_CHIP_SIZE 2048UL
+#define EEPROM_PAGE_SIZE 16
+#define EEPROM_ADDRESS_SIZE 1
+#define EEPROM_CHIPS_COUNT 1
+
+/* Device address 1010 A2 A1 A0 of the first chip */
+#define EEPROM_BASE_DEVICE_ADDRESS 0x50
+
+#define EEPROM_SIZE (EEPROM_CHIP_SIZE * EEPROM_CHIPS_COUNT)
+
+/*
+ * Bytes reached by one device address: with 1 address byte the parts bigger than 256 bytes take the
+ * upper address bits in the device address (e.g. A10 A9 A8 for the 24C16), with 2 address bytes it is one chip.
+ * So the device address of any memory address is the base address plus the memory address / EEPROM_DEVICE_SPAN.
+ */
+#if(EEPROM_ADDRESS_SIZE == 1)
+#define EEPROM_DEVICE_SPAN 256UL
+#elif(EEPROM_ADDRESS_SIZE == 2)
+#define EEPROM_DEVICE_SPAN EEPROM_CHIP_SIZE
+#else
+#error "EEPROM_ADDRESS_SIZE should be 1 or 2"
+#endif
+
+#define EEPROM_DEVICE_ADDRESS(address) ((uint8)(EEPROM_BASE_DEVICE_ADDRESS + ((address) / EEPROM_DEVICE_SPAN)))
+
+#if((EEPROM_SIZE / EEPROM_DEVICE_SPAN) > 8) || ((EEPROM_CHIP_SIZE % EEPROM_DEVICE_SPAN) != 0)
+
+#error "The EEPROM chips do not fit in the 8 device addresses"
+
+#endif
+
+#if((EEPROM_PAGE_SIZE & (EEPROM_PAGE_SIZE - 1)) != 0) || (EEPROM_PAGE_SIZE > 128)
+
+#error "EEPROM_PAGE_SIZE should be a power of 2 up to 128"
+
+#endif
+
+/*
+ * After a write transaction the EEPROM does not answer its address until the internal write cycle
+ * is finished (5 to 10 ms max for the 24Cxx parts, usually 3 to 5 ms), so it is polled by START + SLA+W until
+ * it answers with ACK. The polling gives up after this time.
+ * The polling uses the Timer2 tick, it must be started (LINK_init starts it).
+ */
+#define EEPROM_WRITE_CYCLE_TIMEOUT_MS 20
+
+/*
+ * A blocking transaction is run again after a bus error or a timeout, so its worst case time is
+ * (EEPROM_TRANSACTION_RETRIES + 1) * TWI_TRANSACTION_TIMEOUT_MS with the bus recovery after each timeout.
+ * A write then polls the write cycle for at most EEPROM_WRITE_CYCLE_TIMEOUT_MS.
+ */
+#define EEPROM_TRANSACTION_RETRIES 2
+
+/*
+ * Scratch area written by the throughput self-test, it must not be used by the application.
+ * It is after the credential log (0x0300 to 0x03FF).
+ */
+#define EEPROM_SELF_TEST_ADDRESS 0x0400
+#define EEPROM_SELF_TEST_SIZE 64
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* A memory address over all the chips, 16 bits are enough up to 64 KB */
+#if(EEPROM_SIZE > 65536UL)
+typedef uint32 EEPROM_AddressType;
+#else
+typedef uint16 EEPROM_AddressType;
+#endif
+
+/* Result of the throughput self-test at one SCL frequency */
+typedef struct
+{
+    uint32 sclHz;                /* Real SCL frequency of the bus */
+    uint32 writeBytesPerSecond;  /* Page writes with their write cycles */
+    uint32 readBytesPerSecond;   /* Sequential reads */
+} EEPROM_SelfTestType;
+
+/*
+ * Number of the writes which can wait in the write-behind queue, each one is up to one page
+ * and is copied in the queue so it costs EEPROM_PAGE_SIZE + 3 bytes of RAM.
+ */
+#define EEPROM_WRITE_QUEUE_SIZE 4
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
-uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
-uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
+uint8 EEPROM_writeByte(EEPROM_AddressType address, uint8 u8data);
+uint8 EEPROM_readByte(EEPROM_AddressType address, uint8 *u8data);
+
+/*
+ * Description :
+ * Write a block of bytes starting at the required address. The block is split on the page ends
+ * and each part is written by one transaction followed by one write cycle.
+ */
+uint8 EEPROM_writeBlock(EEPROM_AddressType address, const uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Read a block of bytes starting at the required address by sequential reads, the memory address
+ * is sent once then the bytes are read with ACK and the last one with NACK.
+ */
+uint8 EEPROM_readBlock(EEPROM_AddressType address, uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Poll the EEPROM until it finishes its write cycle. Returns ERROR if it does not answer in time.
+ */
+uint8 EEPROM_waitReady(void);
+
+/*
+ * Description :
+ * Start polling the EEPROM in the background, the call-back function is called from the TWI ISR
+ * with SUCCESS when the write cycle is finished or ERROR if it does not answer in time.
+ * Only one polling can run at the same time.
+ */
+void EEPROM_notifyReady(void (*callBack)(uint8 result));
+
+/*
+ * Description :
+ * Return the measured time of the last write cycle in microseconds.
+ */
+uint16 EEPROM_getWriteCycleTime(void);
+
+/*
+ * Description :
+ * Queue a write of up to one page which must not cross the page end, the data is copied and written
+ * in the background by the TWI ISR so the function returns before the write cycle is finished.
+ * A queued write to the same address and length which is not started yet is replaced by the new data.
+ * It waits only if the queue is full. Returns ERROR if the write does not fit in one page.
+ * The blocking read and write functions wait for the queue to be empty first.
+ */
+uint8 EEPROM_queueWrite(EEPROM_AddressType address, const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Replace the data of a queued write to the same address and length which is not started yet.
+ * Returns FALSE if there is no such write, a write which is already on the bus is never changed.
+ */
+boolean EEPROM_updateQueuedWrite(EEPROM_AddressType address, const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Wait until all the queued writes are stored (a barrier for the write-behind queue).
+ * Returns ERROR if any queued write failed since the last flush.
+ */
+uint8 EEPROM_flush(void);
+
+/*
+ * Description :
+ * Measure the real write and read throughput at the required SCL frequency: the self-test area is written
+ * by page writes then read back by a sequential read and compared, each one is timed with the Timer2 tick.
+ * The bus is left at the tested frequency. Returns ERROR if any transfer fails or the data read back is wrong.
+ * It spends one write cycle of each page of the self-test area so it is not meant for every boot.
+ */
+uint8 EEPROM_selfTest(uint32 scl_hz, EEPROM_SelfTestType *result);
  
 #endif /* EXTERNAL_EEPROM_H_ */
@@ -0,0 +1,308 @@
+ /******************************************************************************
+ *
+ * Module: Software Timer
+ *
+ * File Name: swtimer.c
+ *
+ * Description: Source file for the software timers service, many one-shot timers
+ * share the fixed 1 millisecond tick of Timer1
+ *
+ * The running timers are kept in a delta list sorted by their expiry time: each timer holds
+ * the ticks after the timer before it. The tick decrements only the first timer and the expired
+ * ones are always at the start of the list, so the ISR work does not grow with the running timers.
+ * The sorted insertion is done by SWTIMER_start instead.
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "swtimer.h"
+#include "timer1.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#ifndef COMPARE_MODE_A
+
+#error "The software timers need the COMPARE_MODE_A of Timer1"
+
+#endif
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef struct
+{
+	SWTIMER_CallBackType callBack;  /* NULL_PTR for a free timer */
+	void *context;
+	uint16 delta;                   /* Ticks after the previous timer in the list */
+	SWTIMER_IdType previous;
+	SWTIMER_IdType next;
+}SWTIMER_TimerType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static SWTIMER_TimerType g_timers[SWTIMER_MAX_TIMERS];
+
+/* The timer which expires first, changed by the tick ISR */
+static volatile SWTIMER_IdType g_head = SWTIMER_INVALID_ID;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Take a timer out of the delta list and free it, the interrupts must be disabled.
+ */
+static void SWTIMER_remove(SWTIMER_IdType id);
+
+/*
+ * Description :
+ * Call-back function of Timer1, it runs in the compare match ISR every tick.
+ */
+static void SWTIMER_tick(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the 1 millisecond tick of Timer1, all the timers are stopped.
+ * The global interrupt enable bit (I-bit) must be set in the application.
+ */
+void SWTIMER_init(void)
+{
+	uint8 i;
+
+	Timer1_deInit();
+
+	for(i = 0; i < SWTIMER_MAX_TIMERS; i++)
+	{
+		g_timers[i].callBack = NULL_PTR;
+	}
+	g_head = SWTIMER_INVALID_ID;
+
+	Timer1_startMs(SWTIMER_TICK_MS, TIMER1_PERIODIC, SWTIMER_tick);
+}
+
+/*
+ * Description :
+ * Start a one-shot timer which calls the call-back function after the required number of milliseconds
+ * (1 to 65535), it may be up to 1 millisecond early as the first tick comes at any time after the start.
+ * It can be called from a call-back function to start the next timer of a sequence.
+ * Returns the ID of the timer or SWTIMER_INVALID_ID if all the timers are running.
+ */
+SWTIMER_IdType SWTIMER_start(uint16 duration_ms, SWTIMER_CallBackType callBack, void *context)
+{
+	SWTIMER_IdType id;
+	SWTIMER_IdType previous = SWTIMER_INVALID_ID;
+	SWTIMER_IdType next;
+	uint8 sreg = SREG;
+
+	if(callBack == NULL_PTR)
+	{
+		return SWTIMER_INVALID_ID;
+	}
+
+	/* A timer always waits for at least one tick */
+	if(duration_ms == 0)
+	{
+		duration_ms = 1;
+	}
+
+	cli();
+
+	for(id = 0; id < SWTIMER_MAX_TIMERS; id++)
+	{
+		if(g_timers[id].callBack == NULL_PTR)
+		{
+			break;
+		}
+	}
+
+	if(id == SWTIMER_MAX_TIMERS)
+	{
+		SREG = sreg;
+		return SWTIMER_INVALID_ID;
+	}
+
+	/* Skip the timers which expire before or with the new one, so the timers of the same time expire in their start order */
+	next = g_head;
+	while((next != SWTIMER_INVALID_ID) && (g_timers[next].delta <= duration_ms))
+	{
+		duration_ms -= g_timers[next].delta;
+		previous = next;
+		next = g_timers[next].next;
+	}
+
+	g_timers[id].callBack = callBack;
+	g_timers[id].context = context;
+	g_timers[id].delta = duration_ms;
+	g_timers[id].previous = previous;
+	g_timers[id].next = next;
+
+	if(next != SWTIMER_INVALID_ID)
+	{
+		/* The timer after the new one keeps its expiry time */
+		g_timers[next].delta -= duration_ms;
+		g_timers[next].previous = id;
+	}
+
+	if(previous == SWTIMER_INVALID_ID)
+	{
+		g_head = id;
+	}
+	else
+	{
+		g_timers[previous].next = id;
+	}
+
+	SREG = sreg;
+
+	return id;
+}
+
+/*
+ * Description :
+ * Stop a running timer without calling its call-back function.
+ * Returns FALSE if the timer is not running (e.g. it is already expired).
+ * The ID of an expired timer is given again to a new timer so it must not be kept after the expiry.
+ */
+boolean SWTIMER_cancel(SWTIMER_IdType id)
+{
+	uint8 sreg = SREG;
+
+	if(id >= SWTIMER_MAX_TIMERS)
+	{
+		return FALSE;
+	}
+
+	cli();
+
+	if(g_timers[id].callBack == NULL_PTR)
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+
+	/* The timer after it keeps its expiry time */
+	if(g_timers[id].next != SWTIMER_INVALID_ID)
+	{
+		g_timers[g_timers[id].next].delta += g_timers[id].delta;
+	}
+	SWTIMER_remove(id);
+
+	SREG = sreg;
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return TRUE if the timer is started and not expired or cancelled yet.
+ */
+boolean SWTIMER_isRunning(SWTIMER_IdType id)
+{
+	return (id < SWTIMER_MAX_TIMERS) && (g_timers[id].callBack != NULL_PTR);
+}
+
+/*
+ * Description :
+ * Return the milliseconds left before a running timer expires (the current tick counts as a whole one),
+ * or 0 if the timer is not running.
+ */
+uint16 SWTIMER_getRemaining(SWTIMER_IdType id)
+{
+	uint16 remaining = 0;
+	SWTIMER_IdType timer;
+	uint8 sreg = SREG;
+
+	if(!SWTIMER_isRunning(id))
+	{
+		return 0;
+	}
+
+	cli();
+
+	/* The time of a timer is the sum of the deltas from the start of the list */
+	for(timer = g_head; timer != SWTIMER_INVALID_ID; timer = g_timers[timer].next)
+	{
+		remaining += g_timers[timer].delta;
+		if(timer == id)
+		{
+			break;
+		}
+	}
+
+	/* The timer expired before the interrupts are disabled */
+	if(timer == SWTIMER_INVALID_ID)
+	{
+		remaining = 0;
+	}
+
+	SREG = sreg;
+
+	return remaining;
+}
+
+/*
+ * Description :
+ * Take a timer out of the delta list and free it, the interrupts must be disabled.
+ */
+static void SWTIMER_remove(SWTIMER_IdType id)
+{
+	SWTIMER_IdType previous = g_timers[id].previous;
+	SWTIMER_IdType next = g_timers[id].next;
+
+	if(previous == SWTIMER_INVALID_ID)
+	{
+		g_head = next;
+	}
+	else
+	{
+		g_timers[previous].next = next;
+	}
+
+	if(next != SWTIMER_INVALID_ID)
+	{
+		g_timers[next].previous = previous;
+	}
+
+	g_timers[id].callBack = NULL_PTR;
+}
+
+/*
+ * Description :
+ * Call-back function of Timer1, it runs in the compare match ISR every tick.
+ * Only the first timer is decremented then the expired timers are taken from the start of the list.
+ */
+static void SWTIMER_tick(void)
+{
+	SWTIMER_IdType id = g_head;
+	SWTIMER_CallBackType callBack;
+
+	if(id == SWTIMER_INVALID_ID)
+	{
+		return;
+	}
+
+	g_timers[id].delta--;
+
+	while((id != SWTIMER_INVALID_ID) && (g_timers[id].delta == 0))
+	{
+		/* The timer is freed first so its call-back function can start it again */
+		callBack = g_timers[id].callBack;
+		SWTIMER_remove(id);
+		(*callBack)(g_timers[id].context);
+
+		id = g_head;
+	}
+}
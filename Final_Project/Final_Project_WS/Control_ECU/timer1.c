@@ -23,6 +23,16 @@
 /* Global variables to hold the address of the call back function */
 static volatile void (*g_callBackPtr)(void) = NULL_PTR;
 
+#ifdef COMPARE_MODE_A
+/* Periods of the duration of Timer1_startMs, zero for the timer started by Timer1_init */
+static volatile uint16 g_periods = 0;
+static volatile uint16 g_periodsLeft = 0;
+static Timer1_RunMode g_runMode = TIMER1_ONE_SHOT;
+
+/* Error of the last Timer1_startMs in microseconds */
+static sint32 g_errorUs = 0;
+#endif
+
 /*******************************************************************************
  *                       Interrupt Service Routines                            *
  *******************************************************************************/
@@ -40,6 +50,28 @@ ISR(TIMER1_OVF_vect)
 #ifdef COMPARE_MODE_A
 ISR(TIMER1_COMPA_vect)
 {
+	/* A duration of Timer1_startMs is ended only by the compare match of its last period */
+	if(g_periods != 0)
+	{
+		g_periodsLeft--;
+		if(g_periodsLeft != 0)
+		{
+			return;
+		}
+
+		if(g_runMode == TIMER1_PERIODIC)
+		{
+			g_periodsLeft = g_periods;
+		}
+		else
+		{
+			/* Stop the clock before the call-back function so it can start the timer again */
+			TCCR1B &= 0xF8;
+			CLEAR_BIT(TIMSK, OCIE1A);
+			g_periods = 0;
+		}
+	}
+
 	if(g_callBackPtr != NULL_PTR)
 	{
 		(*g_callBackPtr)();
@@ -129,6 +161,9 @@ void Timer1_deInit(void)
 	CLEAR_BIT(TIMSK, OCIE1B);
 	CLEAR_BIT(TIMSK, TICIE1);
 	g_callBackPtr = NULL_PTR;
+#ifdef COMPARE_MODE_A
+	g_periods = 0;
+#endif
 }
 
 /*
@@ -141,3 +176,79 @@ void Timer1_setCallBack(void(*a_ptr)(void))
 	g_callBackPtr = a_ptr;
 }
 
+#ifdef COMPARE_MODE_A
+/*
+ * Description : The function is responsible for calling the call-back function after the required
+ * number of milliseconds (1 to TIMER1_MAX_DURATION_MS), once or every duration, in the CTC mode.
+ * The smallest prescaler whose period holds the whole duration is used for the best resolution,
+ * a longer duration is split in equal periods at F_CPU/1024 and the call-back function is called
+ * by the ISR of the last one. Returns FALSE if the duration is out of range.
+ *
+ */
+boolean Timer1_startMs(uint32 duration_ms, Timer1_RunMode mode, void(*a_ptr)(void))
+{
+	/* Dividers of F_CPU_DIVIDE_1 ... F_CPU_DIVIDE_1024 */
+	static const uint16 dividers[] = {1, 8, 64, 256, 1024};
+	uint8 i;
+	uint32 divider;
+	uint32 counts;
+	uint32 fraction;
+	uint32 compare;
+	uint16 periods;
+	Timer1_ConfigType Timer1_Configuration;
+
+	if((duration_ms == 0) || (duration_ms > TIMER1_MAX_DURATION_MS))
+	{
+		return FALSE;
+	}
+
+	for(i = 0; i < (sizeof(dividers) / sizeof(dividers[0])) - 1; i++)
+	{
+		if(duration_ms <= ((TIMER1_MAX_COUNTS * dividers[i]) / (F_CPU / 1000)))
+		{
+			break;
+		}
+	}
+	divider = dividers[i];
+
+	/* Timer counts of the duration (duration_ms * F_CPU / 1000 / divider) without an overflow, the fraction is in 1/divider counts */
+	counts = ((duration_ms / divider) * (F_CPU / 1000)) + (((duration_ms % divider) * (F_CPU / 1000)) / divider);
+	fraction = ((duration_ms % divider) * (F_CPU / 1000)) % divider;
+
+	/* The fewest equal periods so each one is at most TIMER1_MAX_COUNTS, the compare value is rounded */
+	periods = (uint16)((counts + TIMER1_MAX_COUNTS - 1) / TIMER1_MAX_COUNTS);
+	compare = (counts + (fraction * 2 >= divider) + (periods / 2)) / periods;
+
+	/* Real counts minus the required ones, each count is divider / (F_CPU / 1000000) microseconds */
+	g_errorUs = ((sint32)((compare * periods) - counts) * (sint32)divider - (sint32)fraction) / (sint32)(F_CPU / 1000000);
+
+	Timer1_deInit();
+
+	/* A compare match left by the previous duration must not end the new one */
+	TIFR = (1<<OCF1A);
+
+	g_runMode = mode;
+	g_periods = periods;
+	g_periodsLeft = periods;
+
+	Timer1_Configuration.initial_value = 0;
+	Timer1_Configuration.compare_value = (uint16)(compare - 1);
+	Timer1_Configuration.prescaler = (Timer1_Prescaler)(F_CPU_DIVIDE_1 + i);
+	Timer1_Configuration.mode = CTC_OCR1A;
+
+	Timer1_setCallBack(a_ptr);
+	Timer1_init(&Timer1_Configuration);
+
+	return TRUE;
+}
+
+/*
+ * Description : The function is responsible for returning the error of the last Timer1_startMs in
+ * microseconds (the real duration minus the required one).
+ *
+ */
+sint32 Timer1_getErrorUs(void)
+{
+	return g_errorUs;
+}
+#endif
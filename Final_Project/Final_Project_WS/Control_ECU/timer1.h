@@ -49,6 +49,15 @@
 #define COM1B (0b00)
 #endif
 
+/* Counts of the longest period in the CTC mode (OCR1A = 65535) */
+#define TIMER1_MAX_COUNTS              65536UL
+
+/* Longest period of Timer1_startMs at F_CPU/1024 (8388 milliseconds at 8 MHz) */
+#define TIMER1_MAX_PERIOD_MS           ((TIMER1_MAX_COUNTS * 1024) / (F_CPU / 1000))
+
+/* Longest duration of Timer1_startMs, 65535 periods counted by the ISR (about 152 hours at 8 MHz) */
+#define TIMER1_MAX_DURATION_MS         (65535UL * TIMER1_MAX_PERIOD_MS)
+
 /*******************************************************************************
  *                         Types Declaration                                   *
  *******************************************************************************/
@@ -72,6 +81,11 @@ typedef struct
 	Timer1_Mode mode;
 } Timer1_ConfigType;
 
+typedef enum
+{
+	TIMER1_ONE_SHOT, TIMER1_PERIODIC
+}Timer1_RunMode;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -96,5 +110,26 @@ void Timer1_deInit(void);
  */
 void Timer1_setCallBack(void(*a_ptr)(void));
 
+#ifdef COMPARE_MODE_A
+/*
+ * Description : The function is responsible for calling the call-back function after the required
+ * number of milliseconds (1 to TIMER1_MAX_DURATION_MS), once or every duration, in the CTC mode.
+ * The smallest prescaler whose period holds the whole duration is used for the best resolution,
+ * a longer duration is split in equal periods at F_CPU/1024 and the call-back function is called
+ * by the ISR of the last one. Returns FALSE if the duration is out of range.
+ *
+ */
+boolean Timer1_startMs(uint32 duration_ms, Timer1_RunMode mode, void(*a_ptr)(void));
+
+/*
+ * Description : The function is responsible for returning the error of the last Timer1_startMs in
+ * microseconds (the real duration minus the required one). It is not more than half a timer count
+ * for each period, e.g. 64 microseconds for each 8.4 seconds period at F_CPU/1024 and 8 MHz,
+ * and it is zero for the durations up to 8 milliseconds at 8 MHz.
+ *
+ */
+sint32 Timer1_getErrorUs(void);
+#endif
+
 
 #endif /* TIMER1_H_ */
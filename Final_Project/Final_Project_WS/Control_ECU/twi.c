@@ -12,7 +12,146 @@
  
 #include "twi.h"
 #include "common_macros.h"
+#include "timer2.h" /* For the transaction timeout */
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h> /* For the bus recovery clock */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Queue of the submitted transactions, the head is the running one */
+static TWI_TransactionType * volatile g_queueHead = NULL_PTR;
+static TWI_TransactionType * volatile g_queueTail = NULL_PTR;
+
+/* Set while the driver runs the queued transactions, the bus is not touched by a new submit */
+static volatile boolean g_busy = FALSE;
+
+/* Progress of the running transaction, used only by the ISR */
+static uint8 g_index;
+static boolean g_reading;
+
+/* Start tick of the running transaction for its timeout */
+static volatile uint16 g_startTick;
+
+/* Set if the last wait on the TWINT flag by the polling functions timed out */
+static boolean g_flagTimeout = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Send the START condition of the transaction at the head of the queue.
+ */
+static void TWI_startTransaction(void);
+
+/*
+ * Description :
+ * Finish the running transaction with the required status, call its call-back function
+ * then send the STOP condition and start the next queued transaction if any.
+ */
+static void TWI_finishTransaction(TWI_TransactionStatus status);
+
+/*
+ * Description :
+ * Wait for the TWINT flag at most TWI_FLAG_WAIT_LOOPS polls, a timeout is reported by TWI_getStatus.
+ */
+static void TWI_waitFlag(void);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(TWI_vect)
+{
+    TWI_TransactionType *transaction = g_queueHead;
+
+    /* TWI_getStatus is not used, its timeout flag belongs to the polling functions */
+    switch(TWSR & 0xF8)
+    {
+    case TWI_START:
+    case TWI_REP_START:
+        /* A transaction with only read bytes starts reading at once */
+        if((transaction->memoryAddressLength == 0) && (transaction->writeLength == 0) && (transaction->readLength != 0))
+        {
+            g_reading = TRUE;
+        }
+        TWDR = (uint8)((transaction->slaveAddress << 1) | g_reading);
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case TWI_MT_SLA_W_ACK:
+    case TWI_MT_DATA_ACK:
+        if(g_index < transaction->memoryAddressLength)
+        {
+            TWDR = transaction->memoryAddress[g_index];
+            g_index++;
+            TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        }
+        else if((uint8)(g_index - transaction->memoryAddressLength) < transaction->writeLength)
+        {
+            TWDR = transaction->writeData[g_index - transaction->memoryAddressLength];
+            g_index++;
+            TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        }
+        else if(transaction->readLength != 0)
+        {
+            /* Repeated START to turn the bus direction for reading */
+            g_reading = TRUE;
+            g_index = 0;
+            TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+        }
+        else
+        {
+            TWI_finishTransaction(TWI_TRANSACTION_DONE);
+        }
+        break;
+
+    case TWI_MR_DATA_ACK:
+        transaction->readData[g_index] = TWDR;
+        g_index++;
+        /* Fall through to ask for the next byte */
+    case TWI_MT_SLA_R_ACK:
+        /* The last byte is read with NACK to tell the slave to release the bus */
+        if((g_index + 1) < transaction->readLength)
+        {
+            TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | (1 << TWEA);
+        }
+        else
+        {
+            TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        }
+        break;
+
+    case TWI_MR_DATA_NACK:
+        transaction->readData[g_index] = TWDR;
+        TWI_finishTransaction(TWI_TRANSACTION_DONE);
+        break;
+
+    case TWI_MT_SLA_W_NACK:
+    case TWI_MT_SLA_R_NACK:
+        TWI_finishTransaction(TWI_TRANSACTION_ADDRESS_NACK);
+        break;
+
+    case TWI_MT_DATA_NACK:
+        TWI_finishTransaction(TWI_TRANSACTION_DATA_NACK);
+        break;
+
+    case TWI_ARB_LOST:
+        /* Another master took the bus, start the transaction again when the bus is free */
+        g_index = 0;
+        g_reading = FALSE;
+        TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    default: /* TWI_BUS_ERROR */
+        TWI_finishTransaction(TWI_TRANSACTION_BUS_ERROR);
+        break;
+    }
+}
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -35,6 +174,262 @@ void TWI_init(const TWI_ConfigType * Config_Ptr)
     TWAR = ((Config_Ptr->address) << 1); // my address = 0x01 :)
 	
     TWCR = (1<<TWEN); /* enable TWI */
+
+    /* A reset in the middle of a read can leave the slave holding SDA low */
+    if(BIT_IS_CLEAR(PINC, TWI_SDA_PIN))
+    {
+        TWI_recoverBus();
+    }
+}
+
+/*
+ * Description :
+ * Functional responsible for enabling the TWI(I2C) Module as a master with the required SCL frequency,
+ * the bit rate register and the prescaler are found by TWI_setBitRate. Returns the real SCL frequency.
+ */
+uint32 TWI_initHz(uint32 scl_hz)
+{
+    uint32 frequency = TWI_setBitRate(scl_hz);
+
+    /* Master only, the slave address is not used and General Call Recognition is Off */
+    TWAR = 0;
+
+    TWCR = (1<<TWEN); /* enable TWI */
+
+    /* A reset in the middle of a read can leave the slave holding SDA low */
+    if(BIT_IS_CLEAR(PINC, TWI_SDA_PIN))
+    {
+        TWI_recoverBus();
+    }
+
+    return frequency;
+}
+
+/*
+ * Description :
+ * Functional responsible for setting the TWBR value and the prescaler found by TWI_findBitRate for the
+ * required SCL frequency. Returns the real SCL frequency. It must not be called while a transaction is running.
+ */
+uint32 TWI_setBitRate(uint32 scl_hz)
+{
+    uint8 bitRate;
+    uint8 prescaler;
+    uint32 frequency = TWI_findBitRate(scl_hz, &bitRate, &prescaler);
+
+    TWBR = bitRate;
+    TWSR = prescaler;
+
+    return frequency;
+}
+
+/*
+ * Description :
+ * Functional responsible for adding a transaction to the queue, it is started at once if the bus is idle.
+ * The next functions (TWI_start ... TWI_readByteWithNACK) wait on the TWINT flag and must not be used
+ * while a queued transaction is running.
+ */
+void TWI_submitTransaction(TWI_TransactionType *transaction)
+{
+    uint8 sreg = SREG;
+
+    transaction->status = TWI_TRANSACTION_PENDING;
+    transaction->next = NULL_PTR;
+
+    /* The queue is changed by the ISR too */
+    cli();
+    if(g_queueHead == NULL_PTR)
+    {
+        g_queueHead = transaction;
+    }
+    else
+    {
+        g_queueTail->next = transaction;
+    }
+    g_queueTail = transaction;
+
+    /* A transaction submitted by a call-back function is started by TWI_finishTransaction */
+    if(g_busy == FALSE)
+    {
+        TWI_startTransaction();
+    }
+    SREG = sreg;
+}
+
+/*
+ * Description :
+ * Functional responsible for waiting until the required transaction is finished and returning its status.
+ */
+TWI_TransactionStatus TWI_waitTransaction(const TWI_TransactionType *transaction)
+{
+    while((transaction->status == TWI_TRANSACTION_PENDING) || (transaction->status == TWI_TRANSACTION_BUSY))
+    {
+        TWI_checkTimeout();
+    }
+
+    return transaction->status;
+}
+
+/*
+ * Description :
+ * Functional responsible for checking if all the queued transactions are finished.
+ */
+boolean TWI_isIdle(void)
+{
+    return (g_busy == FALSE);
+}
+
+/*
+ * Description :
+ * Functional responsible for aborting the running transaction with TWI_TRANSACTION_TIMEOUT and recovering
+ * the bus if it is running for more than TWI_TRANSACTION_TIMEOUT_MS. It is called by the waiting loops
+ * so a stuck bus does not block them forever. The bus recovery and the call-back function of the aborted
+ * transaction run with the interrupts enabled (unlike the call-back functions called by the ISR).
+ */
+void TWI_checkTimeout(void)
+{
+    TWI_TransactionType *transaction;
+    uint8 sreg = SREG;
+
+    /*
+     * Only the detach of the transaction is done with the interrupts disabled, the bus recovery (up to
+     * about 100 us) and the call-back function run with the interrupts enabled so the UART is served.
+     */
+    cli();
+    if((g_busy == FALSE) || !Timer2_isElapsed(g_startTick, TWI_TRANSACTION_TIMEOUT_MS))
+    {
+        SREG = sreg;
+        return;
+    }
+
+    /* The ISR must not run the aborted transaction, g_busy stays TRUE so a new submit is only queued */
+    TWCR = (1 << TWEN);
+    transaction = g_queueHead;
+    g_queueHead = transaction->next;
+    if(g_queueHead == NULL_PTR)
+    {
+        g_queueTail = NULL_PTR;
+    }
+    SREG = sreg;
+
+    TWI_recoverBus();
+
+    transaction->status = TWI_TRANSACTION_TIMEOUT;
+    if(transaction->callBack != NULL_PTR)
+    {
+        /* The call-back function can submit a new transaction, it is started below */
+        (*transaction->callBack)(transaction);
+    }
+
+    /* The next queued transaction is started on the recovered bus */
+    cli();
+    if(g_queueHead == NULL_PTR)
+    {
+        g_busy = FALSE;
+    }
+    else
+    {
+        TWI_startTransaction();
+    }
+    SREG = sreg;
+}
+
+/*
+ * Description :
+ * Functional responsible for freeing a bus held by a slave: the TWI module is disabled, SCL is clocked
+ * until the slave releases SDA (up to TWI_RECOVERY_CLOCKS) then a STOP condition is sent by hand.
+ * Returns TRUE if SDA is released. It must not be called while a transaction is running.
+ */
+boolean TWI_recoverBus(void)
+{
+    uint8 i;
+
+    /* The pins are given back to the port, a pin is pulled low as an output and released as an input */
+    TWCR = 0;
+    CLEAR_BIT(PORTC, TWI_SCL_PIN);
+    CLEAR_BIT(PORTC, TWI_SDA_PIN);
+    CLEAR_BIT(DDRC, TWI_SDA_PIN);
+    CLEAR_BIT(DDRC, TWI_SCL_PIN);
+
+    /* Each clock lets the slave shift out one more bit until it releases SDA */
+    for(i = 0; (i < TWI_RECOVERY_CLOCKS) && BIT_IS_CLEAR(PINC, TWI_SDA_PIN); i++)
+    {
+        SET_BIT(DDRC, TWI_SCL_PIN);
+        _delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+        CLEAR_BIT(DDRC, TWI_SCL_PIN);
+        _delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+    }
+
+    /* STOP condition: SDA rises while SCL is high */
+    SET_BIT(DDRC, TWI_SCL_PIN);
+    SET_BIT(DDRC, TWI_SDA_PIN);
+    _delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+    CLEAR_BIT(DDRC, TWI_SCL_PIN);
+    _delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+    CLEAR_BIT(DDRC, TWI_SDA_PIN);
+    _delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+
+    TWCR = (1 << TWEN);
+
+    return BIT_IS_SET(PINC, TWI_SDA_PIN) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * Send the START condition of the transaction at the head of the queue.
+ */
+static void TWI_startTransaction(void)
+{
+    uint16 loops = TWI_FLAG_WAIT_LOOPS;
+
+    g_busy = TRUE;
+    g_queueHead->status = TWI_TRANSACTION_BUSY;
+    g_index = 0;
+    g_reading = FALSE;
+    g_startTick = Timer2_getTicks();
+
+    /* Wait for the STOP condition of the last transaction to be sent (few SCL periods), a stuck one is left to the timeout */
+    while(BIT_IS_SET(TWCR,TWSTO) && (--loops > 0));
+
+    TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+}
+
+/*
+ * Description :
+ * Finish the running transaction with the required status, call its call-back function
+ * then send the STOP condition and start the next queued transaction if any.
+ */
+static void TWI_finishTransaction(TWI_TransactionStatus status)
+{
+    TWI_TransactionType *transaction = g_queueHead;
+
+    g_queueHead = transaction->next;
+    if(g_queueHead == NULL_PTR)
+    {
+        g_queueTail = NULL_PTR;
+    }
+
+    transaction->status = status;
+    if(transaction->callBack != NULL_PTR)
+    {
+        /* The call-back function can submit a new transaction, it is started below */
+        (*transaction->callBack)(transaction);
+    }
+
+    if(g_queueHead == NULL_PTR)
+    {
+        /* STOP and disable the TWI interrupt until a new transaction is submitted */
+        g_busy = FALSE;
+        TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+    }
+    else
+    {
+        /* STOP followed by the START of the next transaction */
+        g_queueHead->status = TWI_TRANSACTION_BUSY;
+        g_index = 0;
+        g_reading = FALSE;
+        g_startTick = Timer2_getTicks();
+        TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+    }
 }
 
 /*
@@ -51,7 +446,7 @@ void TWI_start(void)
     TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
     
     /* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
 }
 
 /*
@@ -82,7 +477,7 @@ void TWI_writeByte(uint8 data)
 	 */ 
     TWCR = (1 << TWINT) | (1 << TWEN);
     /* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
 }
 
 /*
@@ -98,7 +493,7 @@ uint8 TWI_readByteWithACK(void)
 	 */ 
     TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
     /* Read Data */
     return TWDR;
 }
@@ -115,7 +510,7 @@ uint8 TWI_readByteWithNACK(void)
 	 */
     TWCR = (1 << TWINT) | (1 << TWEN);
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
     /* Read Data */
     return TWDR;
 }
@@ -129,5 +524,24 @@ uint8 TWI_getStatus(void)
     uint8 status;
     /* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
     status = TWSR & 0xF8;
+
+    /* The status register is not updated if the operation did not finish */
+    if(g_flagTimeout == TRUE)
+    {
+        status = TWI_BUS_ERROR;
+    }
     return status;
 }
+
+/*
+ * Description :
+ * Wait for the TWINT flag at most TWI_FLAG_WAIT_LOOPS polls, a timeout is reported by TWI_getStatus.
+ */
+static void TWI_waitFlag(void)
+{
+    uint16 loops = TWI_FLAG_WAIT_LOOPS;
+
+    while(BIT_IS_CLEAR(TWCR,TWINT) && (--loops > 0));
+
+    g_flagTimeout = BIT_IS_CLEAR(TWCR,TWINT) ? TRUE : FALSE;
+}
@@ -19,6 +19,9 @@
  *                         Types Declaration                                   *
  *******************************************************************************/
 
+/* Largest memory address sent at the start of a transaction (2 bytes for the big EEPROMs) */
+#define TWI_MAX_MEMORY_ADDRESS_SIZE    2
+
 typedef uint8 TWI_Address;
 typedef uint8 TWI_BaudRate;
 
@@ -34,6 +37,42 @@ typedef struct
 	TWI_Prescaler prescaler;
 }TWI_ConfigType;
 
+/*
+ * ADDRESS_NACK : the slave did not answer its address (absent or busy, e.g. an EEPROM write cycle).
+ * DATA_NACK    : the slave refused a written byte.
+ * BUS_ERROR    : illegal START or STOP condition on the bus.
+ * TIMEOUT      : the transaction is not finished in TWI_TRANSACTION_TIMEOUT_MS (stuck bus),
+ *                it is aborted and the bus is recovered.
+ */
+typedef enum
+{
+	TWI_TRANSACTION_PENDING, TWI_TRANSACTION_BUSY, TWI_TRANSACTION_DONE, TWI_TRANSACTION_ADDRESS_NACK,
+	TWI_TRANSACTION_DATA_NACK, TWI_TRANSACTION_BUS_ERROR, TWI_TRANSACTION_TIMEOUT
+}TWI_TransactionStatus;
+
+/*
+ * A transaction run in the background by the TWI interrupt:
+ * START, SLA+W, the memory address bytes and the write bytes, then if there are read bytes
+ * a repeated START, SLA+R and the read bytes (ACK after each one except the last), then STOP.
+ * The memory address (e.g. the word address of an EEPROM) is kept in the descriptor so the
+ * write data is sent from the caller buffer without joining it to the address first.
+ * A transaction without write and read bytes only checks if the slave answers its address.
+ * The descriptor and its buffers must stay valid until the transaction is finished.
+ */
+typedef struct TWI_Transaction
+{
+	TWI_Address slaveAddress;      /* 7-bit slave address without the R/W bit */
+	uint8 memoryAddress[TWI_MAX_MEMORY_ADDRESS_SIZE]; /* Sent first, high byte first */
+	uint8 memoryAddressLength;
+	const uint8 *writeData;
+	uint8 writeLength;
+	uint8 *readData;
+	uint8 readLength;
+	void (*callBack)(struct TWI_Transaction *transaction); /* Called from the ISR when finished, can be NULL_PTR */
+	volatile TWI_TransactionStatus status;
+	struct TWI_Transaction *next;  /* Used by the driver queue */
+}TWI_TransactionType;
+
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
  *******************************************************************************/
@@ -46,6 +85,37 @@ typedef struct
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost in slave address or data bytes. */
+#define TWI_MT_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+#define TWI_BUS_ERROR     0x00 /* Illegal START or STOP condition. */
+
+/*
+ * Longest time of one transaction before it is aborted: 255 read bytes with the addresses are about
+ * 2350 SCL periods (23.5 ms at 100 kHz). It uses the Timer2 tick, it must be started (LINK_init starts it).
+ */
+#define TWI_TRANSACTION_TIMEOUT_MS     30
+
+/* Standard and fast mode SCL frequencies */
+#define TWI_SCL_100KHZ                 100000UL
+#define TWI_SCL_400KHZ                 400000UL
+
+/* The master needs TWBR of 10 at least, it limits the SCL frequency to F_CPU / 36 (222 kHz at 8 MHz) */
+#define TWI_MIN_BIT_RATE               10
+#define TWI_SCL_MAX_HZ                 (F_CPU / (16 + (2UL * TWI_MIN_BIT_RATE)))
+
+/* Polls of the TWINT or TWSTO flag before giving up (about 2 ms at 8 MHz, many byte times at 100 kHz) */
+#define TWI_FLAG_WAIT_LOOPS            2000
+
+/*
+ * Bus recovery: a slave which holds SDA low in the middle of a byte releases it after at most 9 SCL clocks,
+ * then a STOP condition resets the slaves. SCL and SDA are PC0 and PC1 driven as open drain pins.
+ */
+#define TWI_RECOVERY_CLOCKS            9
+#define TWI_RECOVERY_HALF_PERIOD_US    5
+#define TWI_SCL_PIN                    0
+#define TWI_SDA_PIN                    1
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -57,6 +127,67 @@ typedef struct
  */
 void TWI_init(const TWI_ConfigType * Config_Ptr);
 
+/*
+ * Description :
+ * Functional responsible for enabling the TWI(I2C) Module as a master with the required SCL frequency,
+ * the bit rate register and the prescaler are found by TWI_setBitRate. Returns the real SCL frequency.
+ */
+uint32 TWI_initHz(uint32 scl_hz);
+
+/*
+ * Description :
+ * Functional responsible for setting the TWBR value and the prescaler found by TWI_findBitRate for the
+ * required SCL frequency. Returns the real SCL frequency. It must not be called while a transaction is running.
+ */
+uint32 TWI_setBitRate(uint32 scl_hz);
+
+/*
+ * Description :
+ * Functional responsible for finding the TWBR value and the prescaler which give the fastest SCL frequency
+ * not above the required one: SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS). TWBR is not set below TWI_MIN_BIT_RATE
+ * so a faster required frequency gives TWI_SCL_MAX_HZ. Returns the real SCL frequency.
+ * The registers are not touched (twi_bit_rate.c), the host model of the bus uses it too.
+ */
+uint32 TWI_findBitRate(uint32 scl_hz, uint8 *bitRate_Ptr, uint8 *prescaler_Ptr);
+
+/*
+ * Description :
+ * Functional responsible for adding a transaction to the queue, it is started at once if the bus is idle.
+ * The next functions (TWI_start ... TWI_readByteWithNACK) wait on the TWINT flag (at most TWI_FLAG_WAIT_LOOPS)
+ * and must not be used while a queued transaction is running.
+ */
+void TWI_submitTransaction(TWI_TransactionType *transaction);
+
+/*
+ * Description :
+ * Functional responsible for waiting until the required transaction is finished and returning its status.
+ * The wait is bounded, a stuck transaction is aborted with TWI_TRANSACTION_TIMEOUT.
+ */
+TWI_TransactionStatus TWI_waitTransaction(const TWI_TransactionType *transaction);
+
+/*
+ * Description :
+ * Functional responsible for checking if all the queued transactions are finished.
+ */
+boolean TWI_isIdle(void);
+
+/*
+ * Description :
+ * Functional responsible for aborting the running transaction with TWI_TRANSACTION_TIMEOUT and recovering
+ * the bus if it is running for more than TWI_TRANSACTION_TIMEOUT_MS. It is called by the waiting loops
+ * so a stuck bus does not block them forever. The bus recovery and the call-back function of the aborted
+ * transaction run with the interrupts enabled (unlike the call-back functions called by the ISR).
+ */
+void TWI_checkTimeout(void);
+
+/*
+ * Description :
+ * Functional responsible for freeing a bus held by a slave: the TWI module is disabled, SCL is clocked
+ * until the slave releases SDA (up to TWI_RECOVERY_CLOCKS) then a STOP condition is sent by hand.
+ * Returns TRUE if SDA is released. It must not be called while a transaction is running.
+ */
+boolean TWI_recoverBus(void);
+
 /*
  * Description :
  * Functional responsible for Sending a Start-Bit.
@@ -90,6 +221,7 @@ uint8 TWI_readByteWithNACK(void);
 /*
  * Description :
  * Functional responsible for Reading the TWI Status Register.
+ * It returns TWI_BUS_ERROR if the last wait on the TWINT flag timed out.
  */
 uint8 TWI_getStatus(void);
 
@@ -0,0 +1,65 @@
+ /******************************************************************************
+ *
+ * Module: TWI(I2C)
+ *
+ * File Name: twi_bit_rate.c
+ *
+ * Description: Source file of the TWI(I2C) bit rate solver, it does not touch the registers so the
+ * host model of the bus (Host_Model/twi_model.c) is built with the same solver as the AVR driver
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include "twi.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Functional responsible for finding the TWBR value and the prescaler which give the fastest SCL frequency
+ * not above the required one: SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS). TWBR is not set below TWI_MIN_BIT_RATE
+ * so a faster required frequency gives TWI_SCL_MAX_HZ. Returns the real SCL frequency.
+ */
+uint32 TWI_findBitRate(uint32 scl_hz, uint8 *bitRate_Ptr, uint8 *prescaler_Ptr)
+{
+    uint8 prescaler;
+    uint32 divider;
+    uint32 step;
+    uint32 bitRate = 0;
+
+    /* SCL periods in CPU clocks rounded up so the bus never runs faster than required */
+    divider = (scl_hz == 0) ? 0xFFFFFFFFUL : ((F_CPU + scl_hz - 1) / scl_hz);
+
+    /* The smallest prescaler which fits TWBR gives the finest frequency steps */
+    for(prescaler = 0; prescaler < 4; prescaler++)
+    {
+        step = 2UL << (2 * prescaler);
+        bitRate = (divider > 16) ? ((divider - 16 + step - 1) / step) : 0;
+        if(bitRate <= 0xFF)
+        {
+            break;
+        }
+    }
+
+    /* The required frequency is below the slowest one (TWBR = 255 with the prescaler 64) */
+    if(prescaler == 4)
+    {
+        prescaler = 3;
+        step = 2UL << (2 * prescaler);
+        bitRate = 0xFF;
+    }
+
+    /* Only the prescaler 1 can give a TWBR below the minimum */
+    if(bitRate < TWI_MIN_BIT_RATE)
+    {
+        bitRate = TWI_MIN_BIT_RATE;
+    }
+
+    *bitRate_Ptr = (uint8)bitRate;
+    *prescaler_Ptr = prescaler;
+
+    return F_CPU / (16 + (bitRate * step));
+}
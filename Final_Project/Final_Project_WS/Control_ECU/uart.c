@@ -13,6 +13,165 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "common_macros.h" /* To use the macros like SET_BIT */
+#include "timer2.h" /* For the receive timeout */
+
+/* Traffic and error counters, written by the ISRs in the interrupt mode */
+static volatile UART_StatisticsType g_statistics;
+
+/*
+ * Description :
+ * Count one received byte and its errors from the UCSRA value read before reading UDR.
+ */
+static void UART_countReceivedByte(uint8 status)
+{
+	g_statistics.bytesIn++;
+
+	if(BIT_IS_SET(status,FE))
+	{
+		g_statistics.framingErrors++;
+	}
+	if(BIT_IS_SET(status,DOR))
+	{
+		g_statistics.dataOverruns++;
+	}
+	if(BIT_IS_SET(status,PE))
+	{
+		g_statistics.parityErrors++;
+	}
+}
+
+#ifdef UART_INTERRUPT_MODE
+#include <avr/interrupt.h> /* For the UART ISRs */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define UART_RX_BUFFER_MASK            (UART_RX_BUFFER_SIZE - 1)
+#define UART_TX_BUFFER_MASK            (UART_TX_BUFFER_SIZE - 1)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Each ring buffer has a head index written only by the producer and a tail index
+ * written only by the consumer, so no critical section is needed to access them.
+ * One place is always kept empty to differ between the full and the empty buffer.
+ * The Rx buffer has UART_RX_FRAME_MAX_SIZE extra places holding a copy of its first
+ * places, so a frame which wraps around the end can be used in place.
+ */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE + UART_RX_FRAME_MAX_SIZE];
+static volatile uint8 g_rxHead = 0; /* Written by the RXC ISR */
+static volatile uint8 g_rxTail = 0; /* Written by the application */
+
+/* Number of received and consumed frame delimiters, their difference is the number of complete frames */
+static volatile uint8 g_rxFramesIn = 0;  /* Written by the RXC ISR */
+static volatile uint8 g_rxFramesOut = 0; /* Written by the application */
+
+/* Start of the frame being received and the drop of its bytes after the Rx buffer is full, used by the RXC ISR */
+static volatile uint8 g_rxFrameStart = 0;
+static volatile boolean g_rxDiscarding = FALSE;
+
+/* Number of the Rx buffer places used by the frame taken by UART_getFrame */
+static uint8 g_rxFrameSize = 0;
+
+static volatile uint8 g_txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8 g_txHead = 0; /* Written by the application */
+static volatile uint8 g_txTail = 0; /* Written by the UDRE ISR */
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(USART_RXC_vect)
+{
+	/* The error flags are valid only until UDR is read */
+	uint8 status = UCSRA;
+	/* Reading UDR clears the RXC flag */
+	uint8 data = UDR;
+	uint8 nextHead = (g_rxHead + 1) & UART_RX_BUFFER_MASK;
+
+	UART_countReceivedByte(status);
+
+	if(g_rxDiscarding == TRUE)
+	{
+		/* The rest of the dropped frame, the receiver starts again after its delimiter */
+		g_statistics.bufferOverflows++;
+		if(data == UART_FRAME_DELIMITER)
+		{
+			g_rxDiscarding = FALSE;
+		}
+	}
+	else if(nextHead == g_rxTail)
+	{
+		/*
+		 * The Rx buffer is full so the frame being received cannot be complete, its received part is
+		 * dropped (the unread part only if the application reads it byte by byte) and its next bytes are
+		 * dropped until its delimiter. Otherwise a frame without a delimiter would fill the buffer for ever
+		 * as the frames are taken out only when they are complete.
+		 */
+		if(((g_rxHead - g_rxTail) & UART_RX_BUFFER_MASK) < ((g_rxHead - g_rxFrameStart) & UART_RX_BUFFER_MASK))
+		{
+			g_rxHead = g_rxTail;
+		}
+		else
+		{
+			g_rxHead = g_rxFrameStart;
+		}
+		g_statistics.bufferOverflows++;
+		g_rxDiscarding = (data != UART_FRAME_DELIMITER);
+	}
+	else
+	{
+		g_rxBuffer[g_rxHead] = data;
+		if(g_rxHead < UART_RX_FRAME_MAX_SIZE)
+		{
+			g_rxBuffer[UART_RX_BUFFER_SIZE + g_rxHead] = data;
+		}
+		g_rxHead = nextHead;
+
+		if(data == UART_FRAME_DELIMITER)
+		{
+			g_rxFramesIn++;
+			g_rxFrameStart = nextHead;
+		}
+	}
+}
+
+ISR(USART_UDRE_vect)
+{
+	if(g_txHead != g_txTail)
+	{
+		/*
+		 * Clear the TXC flag by writing one to it, it will be set again when this byte is completely
+		 * shifted out. Only U2X and MPCM are kept as FE, DOR and PE must be written to zero.
+		 */
+		UCSRA = (UCSRA & ((1<<U2X) | (1<<MPCM))) | (1<<TXC);
+
+		/* Put the next byte in the UDR register, this clears the UDRE flag */
+		UDR = g_txBuffer[g_txTail];
+		g_txTail = (g_txTail + 1) & UART_TX_BUFFER_MASK;
+		g_statistics.bytesOut++;
+	}
+	else
+	{
+		/* Nothing more to send, disable the interrupt until a new byte is queued */
+		CLEAR_BIT(UCSRB,UDRIE);
+	}
+}
+#endif
+
+/* Set when a byte is queued and cleared when UART_flush finds all the bytes shifted out */
+static boolean g_txBusy = FALSE;
+
+/* Baud rate error of the last UART_init in hundredths of a percent */
+static sint16 g_baudRateError = 0;
+
+#ifndef UART_INTERRUPT_MODE
+/* Buffer of the frame returned by UART_getFrame in the polling mode */
+static uint8 g_rxFrame[UART_RX_FRAME_MAX_SIZE];
+#endif
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -33,15 +192,30 @@ void UART_init(const UART_ConfigType * Config_Ptr)
 	UCSRA = (1<<U2X);
 
 	/************************** UCSRB Description **************************
-	 * RXCIE = 0 Disable USART RX Complete Interrupt Enable
+	 * RXCIE = 1 Enable USART RX Complete Interrupt in the interrupt mode
 	 * TXCIE = 0 Disable USART Tx Complete Interrupt Enable
 	 * UDRIE = 0 Disable USART Data Register Empty Interrupt Enable
+	 *           (it is enabled only while the Tx buffer has bytes)
 	 * RXEN  = 1 Receiver Enable
 	 * RXEN  = 1 Transmitter Enable
 	 * RXB8 & TXB8 not used for 9-bit data mode
 	 ***********************************************************************/
 	UCSRB = (1<<RXEN) | (1<<TXEN) | (UCSRB & 0xFB) | ((Config_Ptr->bitData >> 2) << UCSZ2); /* ((Config_Ptr & 4) << (UCSZ2-2)) */
 
+#ifdef UART_INTERRUPT_MODE
+	/* Start with empty ring buffers */
+	g_rxHead = 0;
+	g_rxTail = 0;
+	g_rxFramesIn = 0;
+	g_rxFramesOut = 0;
+	g_rxFrameSize = 0;
+	g_rxFrameStart = 0;
+	g_rxDiscarding = FALSE;
+	g_txHead = 0;
+	g_txTail = 0;
+	SET_BIT(UCSRB,RXCIE);
+#endif
+
 	/************************** UCSRC Description **************************
 	 * URSEL   = 1 The URSEL must be one when writing the UCSRC
 	 * UMSEL   = 0 Asynchronous Operation
@@ -54,8 +228,12 @@ void UART_init(const UART_ConfigType * Config_Ptr)
 		UCSRC |= (TWO_STOP_BITS << USBS);
 	}
 
-	/* Calculate the UBRR register value */
-	ubrr_value = (uint16)(((F_CPU / ((Config_Ptr->baudRate) * 8UL))) - 1);
+	/* Calculate the UBRR register value rounded to the nearest value */
+	ubrr_value = (uint16)(((F_CPU + ((Config_Ptr->baudRate) * 4UL)) / ((Config_Ptr->baudRate) * 8UL)) - 1);
+
+	/* Keep the error between the real and the required baud rate to be reported */
+	g_baudRateError = UART_calculateBaudRateError(Config_Ptr->baudRate);
+	g_txBusy = FALSE;
 
 	/* First 8 bits from the BAUD_PRESCALE inside UBRRL and last 4 bits in UBRRH*/
 	UBRRH = ubrr_value>>8;
@@ -64,88 +242,507 @@ void UART_init(const UART_ConfigType * Config_Ptr)
 
 /*
  * Description :
- * Functional responsible for send byte to another UART device.
+ * Functional responsible for calculate the error between the real baud rate generated by the
+ * UBRR value for the required baud rate (in the double speed mode) and the required baud rate.
+ * The error is returned in hundredths of a percent, e.g. 16 means +0.16%.
  */
-void UART_sendByte(const uint8 data)
+sint16 UART_calculateBaudRateError(UART_BaudRate baudRate)
+{
+	uint32 ubrr_value;
+	uint32 real_baudRate;
+
+	ubrr_value = ((F_CPU + (baudRate * 4UL)) / (baudRate * 8UL)) - 1;
+	real_baudRate = F_CPU / ((ubrr_value + 1) * 8UL);
+
+	return (sint16)((((sint32)real_baudRate - (sint32)baudRate) * 10000L) / (sint32)baudRate);
+}
+
+/*
+ * Description :
+ * Functional responsible for return the baud rate error calculated by the last UART_init
+ * in hundredths of a percent.
+ */
+sint16 UART_getBaudRateError(void)
+{
+	return g_baudRateError;
+}
+
+/*
+ * Description :
+ * Functional responsible for copy the UART traffic and error counters.
+ */
+void UART_getStatistics(UART_StatisticsType *statistics)
+{
+#ifdef UART_INTERRUPT_MODE
+	uint8 sreg = SREG;
+
+	/* The counters are changed by the ISRs, so they are copied with the interrupts disabled */
+	cli();
+	*statistics = *(const UART_StatisticsType *)&g_statistics;
+	SREG = sreg;
+#else
+	*statistics = *(const UART_StatisticsType *)&g_statistics;
+#endif
+}
+
+/*
+ * Description :
+ * Functional responsible for wait until all the queued bytes are completely shifted out,
+ * it is needed before changing the baud rate.
+ */
+void UART_flush(void)
+{
+	if(g_txBusy == TRUE)
+	{
+#ifdef UART_INTERRUPT_MODE
+		while(g_txHead != g_txTail){}
+#endif
+		while(BIT_IS_CLEAR(UCSRA,TXC)){}
+		g_txBusy = FALSE;
+	}
+}
+
+/*
+ * Description :
+ * Functional responsible for queue a byte to be sent to another UART device without waiting.
+ * Returns FALSE if the Tx buffer is full (or UDR is not empty in the polling mode).
+ */
+boolean UART_trySend(const uint8 data)
 {
+#ifdef UART_INTERRUPT_MODE
+	uint8 nextHead = (g_txHead + 1) & UART_TX_BUFFER_MASK;
+
+	if(nextHead == g_txTail)
+	{
+		/* Tx buffer is full */
+		return FALSE;
+	}
+
+	g_txBuffer[g_txHead] = data;
+	g_txHead = nextHead;
+
+	/* The UDRE ISR will send the byte as soon as the UDR register is empty */
+	SET_BIT(UCSRB,UDRIE);
+#else
 	/*
 	 * UDRE flag is set when the Tx buffer (UDR) is empty and ready for
-	 * transmitting a new byte so wait until this flag is set to one
+	 * transmitting a new byte
 	 */
-	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
+	if(BIT_IS_CLEAR(UCSRA,UDRE))
+	{
+		return FALSE;
+	}
+
+	/* Clear the TXC flag, it will be set again when this byte is completely shifted out */
+	UCSRA = (UCSRA & ((1<<U2X) | (1<<MPCM))) | (1<<TXC);
 
 	/*
 	 * Put the required data in the UDR register and it also clear the UDRE flag as
 	 * the UDR register is not empty now
 	 */
 	UDR = data;
-
-	/************************* Another Method *************************
-	UDR = data;
-	while(BIT_IS_CLEAR(UCSRA,TXC)){} // Wait until the transmission is complete TXC = 1
-	SET_BIT(UCSRA,TXC); // Clear the TXC flag
-	*******************************************************************/
+	g_statistics.bytesOut++;
+#endif
+	g_txBusy = TRUE;
+	return TRUE;
 }
 
 /*
  * Description :
- * Functional responsible for receive byte from another UART device.
+ * Functional responsible for take a received byte from another UART device without waiting.
+ * Returns FALSE if there is no received byte yet.
  */
-uint8 UART_recieveByte(void)
+boolean UART_tryReceive(uint8 *data)
 {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	while(BIT_IS_CLEAR(UCSRA,RXC)){}
+#ifdef UART_INTERRUPT_MODE
+	if(g_rxHead == g_rxTail)
+	{
+		/* Rx buffer is empty */
+		return FALSE;
+	}
+
+	*data = g_rxBuffer[g_rxTail];
+	g_rxTail = (g_rxTail + 1) & UART_RX_BUFFER_MASK;
+
+	if(*data == UART_FRAME_DELIMITER)
+	{
+		g_rxFramesOut++;
+	}
+#else
+	/* RXC flag is set when the UART receive data */
+	if(BIT_IS_CLEAR(UCSRA,RXC))
+	{
+		return FALSE;
+	}
+
+	/* The error flags are valid only until UDR is read */
+	UART_countReceivedByte(UCSRA);
 
 	/*
 	 * Read the received data from the Rx buffer (UDR)
 	 * The RXC flag will be cleared after read the data
 	 */
-    return UDR;		
+	*data = UDR;
+#endif
+	return TRUE;
 }
 
 /*
  * Description :
- * Send the required string through UART to the other UART device.
+ * Functional responsible for send byte to another UART device.
+ * Waits only if the Tx buffer is full.
  */
-void UART_sendString(const uint8 *Str)
+void UART_sendByte(const uint8 data)
 {
-	uint8 i = 0;
+	while(!UART_trySend(data)){}
+}
 
-	/* Send the whole string */
-	while(Str[i] != '\0')
+/*
+ * Description :
+ * Functional responsible for receive byte from another UART device.
+ * Waits until a byte is received.
+ */
+uint8 UART_recieveByte(void)
+{
+	uint8 data;
+
+	while(!UART_tryReceive(&data)){}
+
+	return data;
+}
+
+/*
+ * Description :
+ * Receive one byte like UART_recieveByte but wait not more than the required time.
+ * Returns FALSE if no byte is received in time. The Timer2 tick must be started.
+ */
+boolean UART_receiveByteTimeout(uint8 *data, uint16 timeout_ms)
+{
+	uint16 start = Timer2_getTicks();
+
+	while(!UART_tryReceive(data))
+	{
+		if(Timer2_isElapsed(start, timeout_ms))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Discard the received bytes until the frame delimiter to get back in sync with the sender.
+ */
+static void UART_skipFrame(void)
+{
+	while(UART_recieveByte() != UART_FRAME_DELIMITER){}
+}
+
+/*
+ * Description :
+ * Send the required buffer as one COBS encoded frame followed by the frame delimiter.
+ */
+void UART_sendFrame(const uint8 *data, uint8 length)
+{
+	UART_SegmentType segment = {data, length};
+
+	UART_sendv(&segment, 1);
+}
+
+/*
+ * Description :
+ * Move the segments cursor over the finished (or empty) segments.
+ * Returns FALSE if the cursor is at the end of the last segment.
+ */
+static boolean UART_segmentsCursor(const UART_SegmentType *segments, uint8 count, uint8 *segment, uint8 *offset)
+{
+	while((*segment < count) && (*offset >= segments[*segment].length))
+	{
+		(*segment)++;
+		*offset = 0;
+	}
+
+	return (*segment < count);
+}
+
+/*
+ * Description :
+ * Send the required segments one after the other as one COBS encoded frame followed by the frame
+ * delimiter. The segments are encoded directly in the Tx buffer without joining them in a frame buffer.
+ */
+void UART_sendv(const UART_SegmentType *segments, uint8 count)
+{
+	uint8 segment = 0; /* Cursor of the next byte to send */
+	uint8 offset = 0;
+	uint8 scanSegment; /* Cursor looking for the end of the block */
+	uint8 scanOffset;
+	uint8 blockLength;
+
+	while(1)
+	{
+		/* Find the length of the block, it ends at a zero byte, the end of data or after 254 bytes */
+		scanSegment = segment;
+		scanOffset = offset;
+		blockLength = 0;
+		while((blockLength < UART_COBS_MAX_BLOCK) && UART_segmentsCursor(segments, count, &scanSegment, &scanOffset) &&
+				(segments[scanSegment].data[scanOffset] != 0))
+		{
+			blockLength++;
+			scanOffset++;
+		}
+
+		/* The code byte is the distance to the next zero byte */
+		UART_sendByte(blockLength + 1);
+		while(blockLength > 0)
+		{
+			UART_segmentsCursor(segments, count, &segment, &offset);
+			UART_sendByte(segments[segment].data[offset]);
+			offset++;
+			blockLength--;
+		}
+
+		if(!UART_segmentsCursor(segments, count, &segment, &offset))
+		{
+			break;
+		}
+		else if(segments[segment].data[offset] == 0)
+		{
+			/* The zero byte itself is replaced by the code byte of the next block */
+			offset++;
+		}
+		else
+		{
+			/* A full block of 254 non-zero bytes, no zero byte is replaced */
+		}
+	}
+
+	UART_sendByte(UART_FRAME_DELIMITER);
+}
+
+/*
+ * Description :
+ * Receive the next COBS encoded frame and decode it in the required buffer.
+ * At most maxLength bytes are written in the buffer, a longer or corrupted frame is dropped
+ * until its delimiter and an error status is returned.
+ */
+UART_FrameStatus UART_receiveFrame(uint8 *data, uint8 maxLength, uint8 *length)
+{
+	uint8 code;
+	uint8 byte;
+	uint8 i;
+	uint8 count = 0;
+
+	/* Skip the delimiters of the empty frames */
+	do
+	{
+		code = UART_recieveByte();
+	}while(code == UART_FRAME_DELIMITER);
+
+	while(1)
+	{
+		/* Copy the non-zero bytes of the block */
+		for(i = 1; i < code; i++)
+		{
+			byte = UART_recieveByte();
+			if(byte == UART_FRAME_DELIMITER)
+			{
+				/* The frame ended inside a block, the delimiter is already consumed */
+				return UART_FRAME_CORRUPTED;
+			}
+			if(count == maxLength)
+			{
+				UART_skipFrame();
+				return UART_FRAME_TOO_LONG;
+			}
+			data[count++] = byte;
+		}
+
+		byte = UART_recieveByte();
+		if(byte == UART_FRAME_DELIMITER)
+		{
+			/* End of the frame, the zero byte after the last block is not a part of the data */
+			*length = count;
+			return UART_FRAME_OK;
+		}
+
+		/* Each block shorter than 254 bytes was followed by a zero byte */
+		if(code != (UART_COBS_MAX_BLOCK + 1))
+		{
+			if(count == maxLength)
+			{
+				UART_skipFrame();
+				return UART_FRAME_TOO_LONG;
+			}
+			data[count++] = 0;
+		}
+		code = byte;
+	}
+}
+
+#ifdef UART_INTERRUPT_MODE
+/*
+ * Description :
+ * Take the next complete COBS frame without copying it: the frame is decoded in place in
+ * the Rx buffer and a pointer to it is returned with its length. The frame stays valid until
+ * UART_releaseFrame is called. Returns FALSE if no complete frame is received yet.
+ */
+boolean UART_getFrame(const uint8 **data, uint8 *length)
+{
+	uint8 *frame;
+	uint8 size;
+	uint8 in;
+	uint8 out;
+	uint8 code;
+	uint8 i;
+	boolean corrupted;
+
+	while(g_rxFramesIn != g_rxFramesOut)
 	{
-		UART_sendByte(Str[i]);
-		i++;
+		/*
+		 * The frame starts at the tail and it is contiguous thanks to the mirrored places.
+		 * Its bytes are not touched by the RXC ISR until the tail moves after them.
+		 */
+		frame = (uint8 *)&g_rxBuffer[g_rxTail];
+
+		/* Find the delimiter of the frame */
+		size = 0;
+		while((size < UART_RX_FRAME_MAX_SIZE) && (frame[size] != UART_FRAME_DELIMITER))
+		{
+			size++;
+		}
+
+		if(size == UART_RX_FRAME_MAX_SIZE)
+		{
+			/* Too long to be used in place, drop it until its delimiter */
+			while(g_rxBuffer[g_rxTail] != UART_FRAME_DELIMITER)
+			{
+				g_rxTail = (g_rxTail + 1) & UART_RX_BUFFER_MASK;
+			}
+			g_rxTail = (g_rxTail + 1) & UART_RX_BUFFER_MASK;
+			g_rxFramesOut++;
+			continue;
+		}
+
+		/* The decoded bytes are always written behind the encoded bytes which are not read yet */
+		in = 0;
+		out = 0;
+		corrupted = FALSE;
+		while(in < size)
+		{
+			code = frame[in++];
+			if((code - 1) > (size - in))
+			{
+				/* The frame ends inside a block */
+				corrupted = TRUE;
+				break;
+			}
+
+			for(i = 1; i < code; i++)
+			{
+				frame[out++] = frame[in++];
+			}
+
+			/* Each block shorter than 254 bytes was followed by a zero byte except the last one */
+			if((in < size) && (code != (UART_COBS_MAX_BLOCK + 1)))
+			{
+				frame[out++] = 0;
+			}
+		}
+
+		g_rxFrameSize = size + 1;
+
+		if((corrupted == TRUE) || (size == 0))
+		{
+			/* Drop the corrupted or the empty frame */
+			UART_releaseFrame();
+			continue;
+		}
+
+		*data = frame;
+		*length = out;
+		return TRUE;
 	}
-	UART_sendByte('#');
 
-	/************************* Another Method *************************
-	while(*Str != '\0')
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Give back the place of the frame taken by UART_getFrame to the Rx buffer.
+ */
+void UART_releaseFrame(void)
+{
+	if(g_rxFrameSize != 0)
+	{
+		g_rxTail = (g_rxTail + g_rxFrameSize) & UART_RX_BUFFER_MASK;
+		g_rxFramesOut++;
+		g_rxFrameSize = 0;
+	}
+}
+#else
+/*
+ * Description :
+ * Wait for the next COBS frame and decode it in the driver buffer then return a pointer to it
+ * with its length. Returns FALSE if the frame is too long or corrupted.
+ */
+boolean UART_getFrame(const uint8 **data, uint8 *length)
+{
+	if(UART_FRAME_OK != UART_receiveFrame(g_rxFrame, UART_RX_FRAME_MAX_SIZE, length))
 	{
-		UART_sendByte(*Str);
-		Str++;
-	}		
-	*******************************************************************/
+		return FALSE;
+	}
+
+	*data = g_rxFrame;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Nothing to do in the polling mode, the driver buffer is reused by the next frame.
+ */
+void UART_releaseFrame(void)
+{
 }
+#endif
 
 /*
  * Description :
- * Receive the required string until the '#' symbol through UART from the other UART device.
+ * Send the required string through UART to the other UART device as one frame.
  */
-void UART_receiveString(uint8 *Str)
+void UART_sendString(const uint8 *Str)
 {
-	uint8 i = 0;
+	uint8 length = 0;
+
+	while(Str[length] != '\0')
+	{
+		length++;
+	}
 
-	/* Receive the first byte */
-	Str[i] = UART_recieveByte();
+	UART_sendFrame(Str, length);
+}
 
-	/* Receive the whole string until the '#' */
-	while(Str[i] != '#')
+/*
+ * Description :
+ * Receive the required string as one frame through UART from the other UART device.
+ * The string with its null terminator is not more than maxLength bytes,
+ * UART_FRAME_TOO_LONG is returned without writing Str if maxLength is 0.
+ */
+UART_FrameStatus UART_receiveString(uint8 *Str, uint8 maxLength)
+{
+	uint8 length = 0;
+	UART_FrameStatus status;
+
+	/* Not even the null terminator fits, the frame is left in the buffer */
+	if(maxLength == 0)
 	{
-		i++;
-		Str[i] = UART_recieveByte();
+		return UART_FRAME_TOO_LONG;
 	}
 
-	/* After receiving the whole string plus the '#', replace the '#' with '\0' */
-	Str[i] = '\0';
+	/* Keep one place for the null terminator */
+	status = UART_receiveFrame(Str, maxLength - 1, &length);
+
+	Str[length] = '\0';
+	return status;
 }
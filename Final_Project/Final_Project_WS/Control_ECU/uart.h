@@ -15,12 +15,85 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Comment this #define to get back the polling driver which busy-waits on the UDRE and RXC flags.
+ * In the interrupt mode the bytes are moved by the RXC and UDRE interrupts through two ring buffers
+ * and the global interrupt enable bit (I-bit) must be set in the application.
+ */
+#define UART_INTERRUPT_MODE
+
+/* Ring buffers sizes, each one must be a power of two and not more than 256 bytes */
+#define UART_RX_BUFFER_SIZE            64
+#define UART_TX_BUFFER_SIZE            32
+
+#if((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0) || (UART_RX_BUFFER_SIZE > 256)
+
+#error "UART Rx buffer size should be a power of two and not more than 256"
+
+#endif
+
+#if((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0) || (UART_TX_BUFFER_SIZE > 256)
+
+#error "UART Tx buffer size should be a power of two and not more than 256"
+
+#endif
+
+/*
+ * Frames are encoded by COBS (Consistent Overhead Byte Stuffing) so the encoded bytes never
+ * contain a zero and a zero byte is used as the frame delimiter. Any byte value can be sent
+ * with a fixed overhead of 2 bytes (the COBS code byte and the delimiter) for frames up to
+ * 254 bytes, and the receiver gets back in sync at the next zero byte after any corruption.
+ */
+#define UART_FRAME_DELIMITER           0x00
+#define UART_COBS_MAX_BLOCK            254
+
+/*
+ * Largest encoded frame (with its delimiter) which can be taken in place from the Rx buffer
+ * by UART_getFrame. In the interrupt mode the first UART_RX_FRAME_MAX_SIZE places of the Rx
+ * buffer are mirrored after its end, so such a frame is always contiguous in memory even if
+ * it wraps around the ring buffer.
+ */
+#define UART_RX_FRAME_MAX_SIZE         32
+
+#if(UART_RX_FRAME_MAX_SIZE > UART_RX_BUFFER_SIZE)
+
+#error "UART Rx frame max size should not be more than the Rx buffer size"
+
+#endif
+
 /*******************************************************************************
  *                         Types Declaration                                   *
  *******************************************************************************/
 
 typedef uint32 UART_BaudRate;
 
+typedef enum
+{
+	UART_FRAME_OK, UART_FRAME_TOO_LONG, UART_FRAME_CORRUPTED
+}UART_FrameStatus;
+
+/* Counters of the UART traffic and errors since the reset, they are not cleared by UART_init */
+typedef struct
+{
+	uint32 bytesIn;
+	uint32 bytesOut;
+	uint16 framingErrors;   /* FE: the stop bit of a received byte is zero */
+	uint16 dataOverruns;    /* DOR: a byte is lost because the previous one is not read in time */
+	uint16 parityErrors;    /* PE: the parity bit of a received byte is wrong */
+	uint16 bufferOverflows; /* A received byte is dropped because the Rx buffer is full or until the next frame after it */
+}UART_StatisticsType;
+
+/* One part of a frame sent by UART_sendv, like a header, a payload or a trailer */
+typedef struct
+{
+	const uint8 *data;
+	uint8 length;
+}UART_SegmentType;
+
 typedef enum
 {
 	FIVE_BIT_DATA_MODE, SIX_BIT_DATA_MODE, SEVEN_BIT_DATA_MODE, EIGHT_BIT_DATA_MODE, NINE_BIT_DATA_MODE=7
@@ -58,28 +131,117 @@ typedef struct
  */
 void UART_init(const UART_ConfigType * Config_Ptr);
 
+/*
+ * Description :
+ * Functional responsible for calculate the error between the real baud rate generated by the
+ * UBRR value for the required baud rate (in the double speed mode) and the required baud rate.
+ * The error is returned in hundredths of a percent, e.g. 16 means +0.16%.
+ */
+sint16 UART_calculateBaudRateError(UART_BaudRate baudRate);
+
+/*
+ * Description :
+ * Functional responsible for return the baud rate error calculated by the last UART_init
+ * in hundredths of a percent.
+ */
+sint16 UART_getBaudRateError(void);
+
+/*
+ * Description :
+ * Functional responsible for copy the UART traffic and error counters.
+ */
+void UART_getStatistics(UART_StatisticsType *statistics);
+
+/*
+ * Description :
+ * Functional responsible for wait until all the queued bytes are completely shifted out,
+ * it is needed before changing the baud rate.
+ */
+void UART_flush(void);
+
+/*
+ * Description :
+ * Functional responsible for queue a byte to be sent to another UART device without waiting.
+ * Returns FALSE if the Tx buffer is full (or UDR is not empty in the polling mode).
+ */
+boolean UART_trySend(const uint8 data);
+
+/*
+ * Description :
+ * Functional responsible for take a received byte from another UART device without waiting.
+ * Returns FALSE if there is no received byte yet.
+ */
+boolean UART_tryReceive(uint8 *data);
+
 /*
  * Description :
  * Functional responsible for send byte to another UART device.
+ * Waits only if the Tx buffer is full.
  */
 void UART_sendByte(const uint8 data);
 
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Waits until a byte is received.
  */
 uint8 UART_recieveByte(void);
 
 /*
  * Description :
- * Send the required string through UART to the other UART device.
+ * Receive one byte like UART_recieveByte but wait not more than the required time.
+ * Returns FALSE if no byte is received in time. The Timer2 tick must be started.
+ */
+boolean UART_receiveByteTimeout(uint8 *data, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Send the required buffer as one COBS encoded frame followed by the frame delimiter.
+ */
+void UART_sendFrame(const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Send the required segments one after the other as one COBS encoded frame followed by the frame
+ * delimiter. The segments are encoded directly in the Tx buffer without joining them in a frame buffer.
+ */
+void UART_sendv(const UART_SegmentType *segments, uint8 count);
+
+/*
+ * Description :
+ * Receive the next COBS encoded frame and decode it in the required buffer.
+ * At most maxLength bytes are written in the buffer, a longer or corrupted frame is dropped
+ * until its delimiter and an error status is returned.
+ */
+UART_FrameStatus UART_receiveFrame(uint8 *data, uint8 maxLength, uint8 *length);
+
+/*
+ * Description :
+ * Take the next complete COBS frame without copying it: the frame is decoded in place in
+ * the Rx buffer and a pointer to it is returned with its length. The frame stays valid until
+ * UART_releaseFrame is called. Returns FALSE if no complete frame is received yet
+ * (in the polling mode it waits for the frame and decodes it in a driver buffer instead).
+ */
+boolean UART_getFrame(const uint8 **data, uint8 *length);
+
+/*
+ * Description :
+ * Give back the place of the frame taken by UART_getFrame to the Rx buffer.
+ */
+void UART_releaseFrame(void);
+
+/*
+ * Description :
+ * Send the required string through UART to the other UART device as one frame.
  */
 void UART_sendString(const uint8 *Str);
 
 /*
  * Description :
- * Receive the required string until the '#' symbol through UART from the other UART device.
+ * Receive the required string as one frame through UART from the other UART device.
+ * The string with its null terminator is not more than maxLength bytes,
+ * UART_FRAME_TOO_LONG is returned without writing Str if maxLength is 0.
  */
-void UART_receiveString(uint8 *Str); // Receive until #
+UART_FrameStatus UART_receiveString(uint8 *Str, uint8 maxLength);
 
 #endif /* UART_H_ */
@@ -5,26 +5,41 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../MC1.c \
+../crc16.c \
 ../gpio.c \
 ../keypad.c \
 ../lcd.c \
+../link.c \
+../sequence.c \
+../swtimer.c \
 ../timer1.c \
+../timer2.c \
 ../uart.c 
 
 OBJS += \
 ./MC1.o \
+./crc16.o \
 ./gpio.o \
 ./keypad.o \
 ./lcd.o \
+./link.o \
+./sequence.o \
+./swtimer.o \
 ./timer1.o \
+./timer2.o \
 ./uart.o 
 
 C_DEPS += \
 ./MC1.d \
+./crc16.d \
 ./gpio.d \
 ./keypad.d \
 ./lcd.d \
+./link.d \
+./sequence.d \
+./swtimer.d \
 ./timer1.d \
+./timer2.d \
 ./uart.d 
 
 
@@ -12,40 +12,100 @@
  *******************************************************************************/
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
+#include <stdlib.h> /* For the ltoa() and ultoa() functions */
 #include "lcd.h"
 #include "keypad.h"
 #include "uart.h"
-#include "timer1.h"
+#include "link.h"
+#include "sequence.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 
-#define MC1_READY                      0x10
-#define MC2_READY                      0x20
+/* Commands sent to the Control_ECU, each one is the type of a frame */
 #define OPEN_DOOR                      0x30
 #define CHANGE_PASSWORD                0x40
 #define WRONG_PASSWORD                 0x50
+#define NEW_PASSWORD                   0x60
+#define CHECK_PASSWORD                 0x70
+#define GET_STATUS                     0x80
+
+/* One byte results received from the Control_ECU in the reply frame */
 #define SAME                           1
 #define NOT_SAME                       0
 #define MATCHED                        1
 #define NOT_MATCHED                    0
+#define COMMAND_ACCEPTED               1
+#define COMMAND_REJECTED               0xFF
+
+/* Reply of GET_STATUS: the remaining trials before the alarm then TRUE if a new password is expected */
+#define STATUS_TRIALS_LEFT_INDEX       0
+#define STATUS_NEW_PASSWORD_INDEX      1
+#define STATUS_SIZE                    2
 #define PASSWORD_SIZE                  5
 #define MAX_TRIALS                     3
-#define LCD_FINISHED_OPEN_DOOR         6
-#define LCD_FINISHED_WRONG_PASSWORD    9
+
+/* Durations of the door and the alarm messages */
+#define DOOR_UNLOCKING_MS              15000
+#define DOOR_HOLD_MS                   3000
+#define DOOR_LOCKING_MS                15000
+#define ALARM_MS                       60000
+
+/* Messages displayed by the steps of the door and the alarm sequences */
+#define MESSAGE_CLEAR                  0
+#define MESSAGE_UNLOCKING              1
+#define MESSAGE_LOCKING                2
+#define MESSAGE_ERROR                  3
+#define MESSAGE_NONE                   0xFF
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
+/*
+ * Description :
+ * The function responsible for displaying the negotiated UART baud rate and its error for 1-second.
+ */
+void displayLinkSpeed(UART_BaudRate baudRate, sint16 error);
+
+/*
+ * Description :
+ * The function responsible for getting the link back after a command fails because the Control_ECU
+ * does not reply (e.g. it is reset), by negotiating the baud rate again from the default one.
+ */
+void reconnectToControlECU(void);
+
+/*
+ * Description :
+ * The function responsible for displaying one page of link statistics for 2-seconds,
+ * the values are taken from the Control_ECU if remote is TRUE.
+ */
+void displayStatisticsPage(const char *title, const LINK_StatisticId *ids, uint8 count, boolean remote);
+
+/*
+ * Description :
+ * The function responsible for displaying the link statistics of both ECUs page by page.
+ */
+void displayLinkStatistics(void);
+
 /*
  * Description :
  * The function responsible for creating a new password for the system.
  */
 void createPassword(uint8 *password_1, uint8 *password_2);
 
+/*
+ * Description :
+ * The function responsible for sending a command frame to the Control_ECU then waiting
+ * for its reply frame and returning the one byte result in it.
+ * COMMAND_REJECTED is returned if the Control_ECU does not reply after all the retries.
+ */
+uint8 sendCommandToControlECU(uint8 command, const uint8 *data, uint8 length);
+
 /*
  * Description :
  * The function responsible for sending the two passwords to the Control_ECU through the UART
@@ -53,6 +113,28 @@ void createPassword(uint8 *password_1, uint8 *password_2);
  */
 uint8 checkSamePasswordsInControlECU(uint8 *password_1, uint8 *password_2);
 
+/*
+ * Description :
+ * The function responsible for creating a new password until the Control_ECU saves it,
+ * the user is asked again if the two passwords are not the same or the Control_ECU rejects them.
+ * It gives up if the Control_ECU expects no new password any more (it is reset during a change).
+ */
+void saveNewPasswordInControlECU(uint8 *password_1, uint8 *password_2);
+
+/*
+ * Description :
+ * The function responsible for asking the Control_ECU if it expects a new password (none is saved
+ * or a change is accepted). Returns TRUE or FALSE, or COMMAND_REJECTED if the Control_ECU does not reply.
+ */
+uint8 isNewPasswordNeededInControlECU(void);
+
+/*
+ * Description :
+ * The function responsible for creating a new password only if the Control_ECU expects one,
+ * it is called at the start and after the link is lost as any of the two ECUs may be reset.
+ */
+void setupPasswordInControlECU(uint8 *password_1, uint8 *password_2);
+
 /*
  * Description :
  * The function responsible for taking the password from the user as an input.
@@ -63,34 +145,81 @@ void userWritePassword(uint8 *doorPassword);
  * Description :
  * The function responsible for sending the password to the Control_ECU through the UART to check
  * if it matches the one saved in the EEPROM or not then responds through the UART.
+ * COMMAND_REJECTED is returned if the Control_ECU does not reply or does not check the password
+ * (e.g. during the alarm), it is not a wrong password.
  */
 uint8 checkPasswordInControlECU(uint8 *password);
 
 /*
  * Description :
- * The function responsible for starting Timer1 based on the configurations passed as parameters
- * and pass the address of the call-back function.
+ * The function responsible for telling the user for 1-second that the password is not checked,
+ * the user goes back to the menu without losing a trial.
  */
-void startTimer1(uint16 TCNT_value, uint16 OCR_value, Timer1_Prescaler prescaler, Timer1_Mode mode, void(*callBackFunctionAddress)(void));
+void displayCheckRejected(void);
 
 /*
  * Description :
  * This is a function responsible for displaying "Door is Unlocking" for 15-seconds then clear
  * the LCD for 3-seconds then "Door is Locking" for 15-seconds on the LCD.
+ * The steps are run in the background by the sequence engine.
  */
 void APP_openDoor(void);
 
 /*
  * Description :
  * This is a function responsible for displaying "ERROR" on the LCD for 1-minute.
+ * The steps are run in the background by the sequence engine.
  */
 void APP_wrongPassword(void);
 
+/*
+ * Description :
+ * The function responsible for asking the Control_ECU to start the alarm after MAX_TRIALS wrong passwords
+ * then displaying "ERROR" until the alarm is finished, an error is shown for 1-second instead if the
+ * Control_ECU rejects the command (e.g. its trials counter is below MAX_TRIALS) or does not reply.
+ */
+void APP_startAlarm(void);
+
+/*
+ * Description :
+ * Step action of the door and the alarm sequences, it posts the required message to the main loop
+ * as the LCD must not be written in the ISR.
+ */
+void APP_displayMessage(uint8 message);
+
+/*
+ * Description :
+ * The function responsible for waiting until the displayed sequence is finished while
+ * displaying the messages posted by its steps on the LCD.
+ */
+void APP_waitDisplaySequence(void);
+
 /*******************************************************************************
  *                           Global Variables                                  *
  *******************************************************************************/
 
-uint8 g_ticks_LCD;
+/* Door: unlocking, hold then locking */
+const SEQUENCE_StepType g_openDoorSteps[] PROGMEM =
+{
+	{APP_displayMessage, MESSAGE_UNLOCKING, DOOR_UNLOCKING_MS},
+	{APP_displayMessage, MESSAGE_CLEAR, DOOR_HOLD_MS},
+	{APP_displayMessage, MESSAGE_LOCKING, DOOR_LOCKING_MS}
+};
+
+/* Alarm: the error message for 1-minute */
+const SEQUENCE_StepType g_wrongPasswordSteps[] PROGMEM =
+{
+	{APP_displayMessage, MESSAGE_ERROR, ALARM_MS}
+};
+
+/* The displayed sequence, the main loop waits until it is finished */
+SEQUENCE_Type g_lcdSequence;
+
+/* Message posted by the last step, displayed by the main loop */
+volatile uint8 g_pendingMessage = MESSAGE_NONE;
+
+/* Set when the link is negotiated again, the main loop asks the Control_ECU for its password state */
+boolean g_linkReconnected = FALSE;
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -103,21 +232,34 @@ int main(void)
 	uint8 secondPassword[5];
 	uint8 doorPassword[5];
 	uint8 wrongPasswordCounter;
+	uint8 result;
+	UART_BaudRate baudRate;
 
 	SREG |= (1<<7);
 
-	UART_ConfigType UART_Configurations = {EIGHT_BIT_DATA_MODE, DISABLED, ONE_STOP_BIT, 9600};
-	UART_init(&UART_Configurations);
+	UART_ConfigType UART_Configurations = {EIGHT_BIT_DATA_MODE, DISABLED, ONE_STOP_BIT, LINK_DEFAULT_BAUD_RATE};
+	LINK_init(&UART_Configurations);
 
 	LCD_init();
 
-	do
-	{
-		createPassword(firstPassword, secondPassword);
-	}while(NOT_SAME == checkSamePasswordsInControlECU(firstPassword, secondPassword));
+	SWTIMER_init();
+
+	/* Switch the link to the fastest baud rate supported by both ECUs */
+	baudRate = LINK_negotiateBaudRate();
+	displayLinkSpeed(baudRate, UART_getBaudRateError());
+
+	/* A Control_ECU which is not reset keeps its saved password */
+	setupPasswordInControlECU(firstPassword, secondPassword);
 
 	while(1)
 	{
+		/* The Control_ECU may be reset while the link was lost */
+		while(g_linkReconnected == TRUE)
+		{
+			g_linkReconnected = FALSE;
+			setupPasswordInControlECU(firstPassword, secondPassword);
+		}
+
 		/* Display the menu */
 		LCD_clearScreen();
 		LCD_displayStringRowColumn(0, 0, "+ : Open Door");
@@ -126,37 +268,49 @@ int main(void)
 		do
 		{
 			key = KEYPAD_getPressedKey();
-		}while((key != '+') && (key != '-'));
+		}while((key != '+') && (key != '-') && (key != '*'));
 
-		if(key == '+')
+		if(key == '*') /* Hidden diagnostic key */
+		{
+			displayLinkStatistics();
+		}
+		else if(key == '+')
 		{
 			wrongPasswordCounter = 0;
 			while(wrongPasswordCounter < MAX_TRIALS)
 			{
 				userWritePassword(doorPassword);
-				if(MATCHED == checkPasswordInControlECU(doorPassword))
+				result = checkPasswordInControlECU(doorPassword);
+				if(MATCHED == result)
 				{
-					g_ticks_LCD = 0;
-					while(UART_recieveByte() != MC2_READY);
-					UART_sendByte(OPEN_DOOR);
-					APP_openDoor();
-					while(g_ticks_LCD != LCD_FINISHED_OPEN_DOOR);
+					/* The door messages are shown only if the Control_ECU really moves the door */
+					if(COMMAND_ACCEPTED == sendCommandToControlECU(OPEN_DOOR, NULL_PTR, 0))
+					{
+						APP_openDoor();
+						APP_waitDisplaySequence();
+					}
+					else
+					{
+						LCD_clearScreen();
+						LCD_displayStringRowColumn(0, 0, "Door rejected");
+						_delay_ms(1000);
+					}
 					break;
 				}
-				else
+				else if(NOT_MATCHED == result)
 				{
 					wrongPasswordCounter++;
 				}
+				else /* COMMAND_REJECTED: no reply or the password cannot be checked now, it is not a trial */
+				{
+					displayCheckRejected();
+					break;
+				}
 			}
 
 			if(wrongPasswordCounter == MAX_TRIALS) /* NOT_MATCHED for 3 times */
 			{
-				while(UART_recieveByte() != MC2_READY);
-				UART_sendByte(WRONG_PASSWORD);
-
-				g_ticks_LCD = 0;
-				APP_wrongPassword();
-				while(g_ticks_LCD != LCD_FINISHED_WRONG_PASSWORD);
+				APP_startAlarm();
 			}
 		}
 		else if(key == '-')
@@ -165,37 +319,153 @@ int main(void)
 			while(wrongPasswordCounter < MAX_TRIALS)
 			{
 				userWritePassword(doorPassword);
-				if(MATCHED == checkPasswordInControlECU(doorPassword))
+				result = checkPasswordInControlECU(doorPassword);
+				if(MATCHED == result)
 				{
-					while(UART_recieveByte() != MC2_READY);
-					UART_sendByte(CHANGE_PASSWORD);
-
-					do
+					/* The old password is kept if the Control_ECU does not allow the change */
+					if(COMMAND_REJECTED == sendCommandToControlECU(CHANGE_PASSWORD, NULL_PTR, 0))
 					{
-						createPassword(firstPassword, secondPassword);
-					}while(NOT_SAME == checkSamePasswordsInControlECU(firstPassword, secondPassword));
+						LCD_clearScreen();
+						LCD_displayStringRowColumn(0, 0, "Change rejected");
+						_delay_ms(1000);
+						break;
+					}
+
+					saveNewPasswordInControlECU(firstPassword, secondPassword);
 					break;
 				}
-				else
+				else if(NOT_MATCHED == result)
 				{
 					wrongPasswordCounter++;
 				}
+				else /* COMMAND_REJECTED: no reply or the password cannot be checked now, it is not a trial */
+				{
+					displayCheckRejected();
+					break;
+				}
 			}
 
 			if(wrongPasswordCounter == MAX_TRIALS) /* NOT_MATCHED for 3 times */
 			{
-				while(UART_recieveByte() != MC2_READY);
-				UART_sendByte(WRONG_PASSWORD);
-
-				g_ticks_LCD = 0;
-				APP_wrongPassword();
-				while(g_ticks_LCD != LCD_FINISHED_WRONG_PASSWORD);
+				APP_startAlarm();
 			}
 		}
 	}
 	return 0;
 }
 
+/*
+ * Description :
+ * The function responsible for displaying the negotiated UART baud rate and its error for 1-second.
+ */
+void displayLinkSpeed(UART_BaudRate baudRate, sint16 error)
+{
+	char buff[11]; /* String to hold the ascii result */
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "Baud: ");
+	ltoa(baudRate, buff, 10); /* Use ltoa as the baud rate does not fit in an int */
+	LCD_displayString(buff);
+
+	/* The error is in hundredths of a percent */
+	LCD_displayStringRowColumn(1, 0, "Error: ");
+	if(error < 0)
+	{
+		LCD_displayCharacter('-');
+		error = -error;
+	}
+	LCD_intgerToString(error / 100);
+	LCD_displayCharacter('.');
+	if((error % 100) < 10)
+	{
+		LCD_displayCharacter('0');
+	}
+	LCD_intgerToString(error % 100);
+	LCD_displayCharacter('%');
+
+	_delay_ms(1000);
+}
+
+/*
+ * Description :
+ * The function responsible for getting the link back after a command fails because the Control_ECU
+ * does not reply (e.g. it is reset), by negotiating the baud rate again from the default one.
+ */
+void reconnectToControlECU(void)
+{
+	UART_BaudRate baudRate;
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "Link lost");
+	LCD_displayStringRowColumn(1, 0, "Reconnecting...");
+
+	baudRate = LINK_negotiateBaudRate();
+	displayLinkSpeed(baudRate, UART_getBaudRateError());
+
+	g_linkReconnected = TRUE;
+}
+
+/*
+ * Description :
+ * The function responsible for displaying one page of link statistics for 2-seconds,
+ * the values are taken from the Control_ECU if remote is TRUE.
+ */
+void displayStatisticsPage(const char *title, const LINK_StatisticId *ids, uint8 count, boolean remote)
+{
+	char buff[11]; /* String to hold the ascii result */
+	uint32 value;
+	uint8 i;
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, title);
+	LCD_moveCursor(1, 0);
+
+	for(i = 0; i < count; i++)
+	{
+		if(i != 0)
+		{
+			LCD_displayCharacter('/');
+		}
+
+		if(remote == FALSE)
+		{
+			value = LINK_getStatistic(ids[i]);
+		}
+		else if(LINK_OK != LINK_getRemoteStatistic(ids[i], &value))
+		{
+			LCD_displayCharacter('?');
+			continue;
+		}
+
+		ultoa(value, buff, 10); /* Use ultoa as the counters do not fit in an int */
+		LCD_displayString(buff);
+	}
+
+	_delay_ms(2000);
+}
+
+/*
+ * Description :
+ * The function responsible for displaying the link statistics of both ECUs page by page.
+ */
+void displayLinkStatistics(void)
+{
+	const LINK_StatisticId roundTrip[] = {LINK_MIN_ROUND_TRIP_US, LINK_AVG_ROUND_TRIP_US, LINK_MAX_ROUND_TRIP_US};
+	const LINK_StatisticId retries[] = {LINK_RETRANSMISSIONS, LINK_FAILED_REQUESTS};
+	const LINK_StatisticId traffic[] = {LINK_BYTES_OUT, LINK_BYTES_IN};
+	const LINK_StatisticId lineErrors[] = {LINK_FRAMING_ERRORS, LINK_DATA_OVERRUNS, LINK_PARITY_ERRORS};
+	const LINK_StatisticId frameErrors[] = {LINK_CRC_ERRORS, LINK_LENGTH_ERRORS, LINK_BUFFER_OVERFLOWS};
+
+	/* The local pages are shown first as the remote requests change the local statistics */
+	displayStatisticsPage("RTT min/avg/max", roundTrip, 3, FALSE);
+	displayStatisticsPage("Retries/Failed", retries, 2, FALSE);
+	displayStatisticsPage("Bytes out/in", traffic, 2, FALSE);
+	displayStatisticsPage("HMI FE/DOR/PE", lineErrors, 3, FALSE);
+	displayStatisticsPage("HMI CRC/Len/Ovf", frameErrors, 3, FALSE);
+	displayStatisticsPage("Ctrl FE/DOR/PE", lineErrors, 3, TRUE);
+	displayStatisticsPage("Ctrl CRC/Len/Ovf", frameErrors, 3, TRUE);
+}
+
 /*
  * Description :
  * The function responsible for creating a new password for the system.
@@ -244,6 +514,34 @@ void createPassword(uint8 *password_1, uint8 *password_2)
 	LCD_moveCursor(0,0);
 }
 
+/*
+ * Description :
+ * The function responsible for sending a command frame to the Control_ECU then waiting
+ * for its reply frame and returning the one byte result in it.
+ * COMMAND_REJECTED is returned if the Control_ECU does not reply after all the retries.
+ */
+uint8 sendCommandToControlECU(uint8 command, const uint8 *data, uint8 length)
+{
+	uint8 sequence;
+	uint8 reply[LINK_MAX_REPLY_SIZE];
+	uint8 replyLength;
+
+	/* Wait for a free place in the window if the previous requests are not answered yet */
+	while(!LINK_submitRequest(command, data, length, &sequence))
+	{
+		LINK_poll();
+	}
+
+	/* The request is sent again by the link layer until it is answered or its retries are finished */
+	if(LINK_OK != LINK_waitReply(sequence, reply, &replyLength))
+	{
+		reconnectToControlECU();
+		return COMMAND_REJECTED;
+	}
+
+	return reply[0];
+}
+
 /*
  * Description :
  * The function responsible for sending the two passwords to the Control_ECU through the UART
@@ -252,22 +550,94 @@ void createPassword(uint8 *password_1, uint8 *password_2)
 uint8 checkSamePasswordsInControlECU(uint8 *password_1, uint8 *password_2)
 {
 	uint8 i;
-	uint8 sameFlag;
+	uint8 passwords[2 * PASSWORD_SIZE];
 
+	/* Both passwords are sent in one frame */
 	for(i = 0; i < PASSWORD_SIZE; i++)
 	{
-		while(UART_recieveByte() != MC2_READY);
-		UART_sendByte(password_1[i]);
+		passwords[i] = password_1[i];
+		passwords[PASSWORD_SIZE + i] = password_2[i];
 	}
 
-	for(i = 0; i < PASSWORD_SIZE; i++)
+	return sendCommandToControlECU(NEW_PASSWORD, passwords, 2 * PASSWORD_SIZE);
+}
+
+/*
+ * Description :
+ * The function responsible for creating a new password until the Control_ECU saves it,
+ * the user is asked again if the two passwords are not the same or the Control_ECU rejects them.
+ * It gives up if the Control_ECU expects no new password any more (it is reset during a change).
+ */
+void saveNewPasswordInControlECU(uint8 *password_1, uint8 *password_2)
+{
+	uint8 result;
+
+	do
+	{
+		createPassword(password_1, password_2);
+		result = checkSamePasswordsInControlECU(password_1, password_2);
+
+		/* No reply or a failed save, the password is not stored in the Control_ECU */
+		if(result == COMMAND_REJECTED)
+		{
+			LCD_clearScreen();
+			LCD_displayStringRowColumn(0, 0, "Pass not saved");
+			LCD_displayStringRowColumn(1, 0, "Try again");
+			_delay_ms(1000);
+
+			/* A Control_ECU reset during a change keeps its old password and expects no new one */
+			if(FALSE == isNewPasswordNeededInControlECU())
+			{
+				return;
+			}
+		}
+	}while(result != SAME);
+}
+
+/*
+ * Description :
+ * The function responsible for asking the Control_ECU if it expects a new password (none is saved
+ * or a change is accepted). Returns TRUE or FALSE, or COMMAND_REJECTED if the Control_ECU does not reply.
+ */
+uint8 isNewPasswordNeededInControlECU(void)
+{
+	uint8 sequence;
+	uint8 status[LINK_MAX_REPLY_SIZE];
+	uint8 replyLength;
+
+	while(!LINK_submitRequest(GET_STATUS, NULL_PTR, 0, &sequence))
 	{
-		while(UART_recieveByte() != MC2_READY);
-		UART_sendByte(password_2[i]);
+		LINK_poll();
+	}
+
+	if((LINK_OK != LINK_waitReply(sequence, status, &replyLength)) || (replyLength < STATUS_SIZE))
+	{
+		reconnectToControlECU();
+		return COMMAND_REJECTED;
+	}
+
+	return (status[STATUS_NEW_PASSWORD_INDEX] == TRUE) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * The function responsible for creating a new password only if the Control_ECU expects one,
+ * it is called at the start and after the link is lost as any of the two ECUs may be reset.
+ */
+void setupPasswordInControlECU(uint8 *password_1, uint8 *password_2)
+{
+	uint8 needed;
+
+	/* Asked again until the Control_ECU replies, each failure negotiates the link again */
+	do
+	{
+		needed = isNewPasswordNeededInControlECU();
+	}while(needed == COMMAND_REJECTED);
+
+	if(needed == TRUE)
+	{
+		saveNewPasswordInControlECU(password_1, password_2);
 	}
-	UART_sendByte(MC1_READY);
-	sameFlag = UART_recieveByte();
-	return sameFlag;
 }
 
 /*
@@ -302,132 +672,157 @@ void userWritePassword(uint8 *doorPassword)
  * Description :
  * The function responsible for sending the password to the Control_ECU through the UART to check
  * if it matches the one saved in the EEPROM or not then responds through the UART.
+ * COMMAND_REJECTED is returned if the Control_ECU does not reply or does not check the password
+ * (e.g. during the alarm), it is not a wrong password.
  */
 uint8 checkPasswordInControlECU(uint8 *password)
 {
-	uint8 i;
-	uint8 matchedFlag;
+	uint8 checkSequence;
+	uint8 statusSequence;
+	uint8 matchedFlag[LINK_MAX_REPLY_SIZE];
+	uint8 trialsLeft[LINK_MAX_REPLY_SIZE];
+	uint8 replyLength;
+	LINK_Status checkStatus;
+	LINK_Status statusStatus;
+
+	/* The status query is sent behind the password check without waiting, both replies come in one round trip */
+	while(!LINK_submitRequest(CHECK_PASSWORD, password, PASSWORD_SIZE, &checkSequence))
+	{
+		LINK_poll();
+	}
+	while(!LINK_submitRequest(GET_STATUS, NULL_PTR, 0, &statusSequence))
+	{
+		LINK_poll();
+	}
 
-	for(i = 0; i < PASSWORD_SIZE; i++)
+	checkStatus = LINK_waitReply(checkSequence, matchedFlag, &replyLength);
+	statusStatus = LINK_waitReply(statusSequence, trialsLeft, &replyLength);
+
+	if((checkStatus != LINK_OK) || (statusStatus != LINK_OK))
 	{
-		while(UART_recieveByte() != MC2_READY);
-		UART_sendByte(password[i]);
+		reconnectToControlECU();
+		return COMMAND_REJECTED;
 	}
 
-	UART_sendByte(MC1_READY);
-	matchedFlag = UART_recieveByte();
-	return matchedFlag;
+	if((matchedFlag[0] == NOT_MATCHED) && (trialsLeft[STATUS_TRIALS_LEFT_INDEX] != 0))
+	{
+		LCD_clearScreen();
+		LCD_displayStringRowColumn(0, 0, "Wrong password");
+		LCD_displayStringRowColumn(1, 0, "Trials left: ");
+		LCD_intgerToString(trialsLeft[STATUS_TRIALS_LEFT_INDEX]);
+		_delay_ms(1000);
+	}
+
+	return matchedFlag[0];
 }
 
 /*
  * Description :
- * The function responsible for starting Timer1 based on the configurations passed as parameters
- * and pass the address of the call-back function.
+ * The function responsible for telling the user for 1-second that the password is not checked,
+ * the user goes back to the menu without losing a trial.
  */
-void startTimer1(uint16 TCNT_value, uint16 OCR_value, Timer1_Prescaler prescaler, Timer1_Mode mode, void(*callBackFunctionAddress)(void))
+void displayCheckRejected(void)
 {
-	Timer1_ConfigType Timer1_Configurations;
-
-	Timer1_Configurations.initial_value = TCNT_value;
-	Timer1_Configurations.compare_value = OCR_value; // 62500 = 8 seconds //54687 == 7 seconds
-	Timer1_Configurations.prescaler = prescaler;
-	Timer1_Configurations.mode = mode;
-
-	Timer1_setCallBack(callBackFunctionAddress);
-	Timer1_init(&Timer1_Configurations);
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "Not checked");
+	LCD_displayStringRowColumn(1, 0, "Try again");
+	_delay_ms(1000);
 }
 
 /*
  * Description :
  * This is a function responsible for displaying "Door is Unlocking" for 15-seconds then clear
  * the LCD for 3-seconds then "Door is Locking" for 15-seconds on the LCD.
+ * The steps are run in the background by the sequence engine.
  */
 void APP_openDoor(void)
 {
-	g_ticks_LCD++;
+	SEQUENCE_start(&g_lcdSequence, g_openDoorSteps, sizeof(g_openDoorSteps) / sizeof(g_openDoorSteps[0]), NULL_PTR);
+}
 
-	if(g_ticks_LCD == 1)
-	{
-		LCD_clearScreen();
-		LCD_displayStringRowColumn(0, 4, "Door is");
-		LCD_displayStringRowColumn(1, 3, "Unlocking");
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_openDoor);  /* 62500 = 8 seconds */
-	}
-	else if(g_ticks_LCD == 2)
+/*
+ * Description :
+ * This is a function responsible for displaying "ERROR" on the LCD for 1-minute.
+ * The steps are run in the background by the sequence engine.
+ */
+void APP_wrongPassword(void)
+{
+	SEQUENCE_start(&g_lcdSequence, g_wrongPasswordSteps, sizeof(g_wrongPasswordSteps) / sizeof(g_wrongPasswordSteps[0]), NULL_PTR);
+}
+
+/*
+ * Description :
+ * The function responsible for asking the Control_ECU to start the alarm after MAX_TRIALS wrong passwords
+ * then displaying "ERROR" until the alarm is finished, an error is shown for 1-second instead if the
+ * Control_ECU rejects the command (e.g. its trials counter is below MAX_TRIALS) or does not reply.
+ */
+void APP_startAlarm(void)
+{
+	if(COMMAND_ACCEPTED == sendCommandToControlECU(WRONG_PASSWORD, NULL_PTR, 0))
 	{
-		Timer1_deInit();
-		startTimer1(0x00, 54687, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_openDoor);  /* 54687 = 7 seconds */
+		APP_wrongPassword();
+		APP_waitDisplaySequence();
 	}
-	else if(g_ticks_LCD == 3)
+	else
 	{
 		LCD_clearScreen();
-		Timer1_deInit();
-		startTimer1(0x00, 23437, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_openDoor);  /* 23437 == 3 seconds */
-	}
-	else if(g_ticks_LCD == 4)
-	{
-		LCD_displayString("Door is Locking");
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_openDoor);  /* 62500 = 8 seconds */
-	}
-	else if(g_ticks_LCD == 5)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 54687, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_openDoor);  /* 54687 = 7 seconds */
+		LCD_displayStringRowColumn(0, 0, "Alarm rejected");
+		_delay_ms(1000);
 	}
 }
 
 /*
  * Description :
- * This is a function responsible for displaying "ERROR" on the LCD for 1-minute.
+ * Step action of the door and the alarm sequences, it posts the required message to the main loop
+ * as the LCD must not be written in the ISR.
  */
-void APP_wrongPassword(void)
+void APP_displayMessage(uint8 message)
 {
-	g_ticks_LCD++;
+	g_pendingMessage = message;
+}
 
-	if(g_ticks_LCD == 1)
+/*
+ * Description :
+ * The function responsible for waiting until the displayed sequence is finished while
+ * displaying the messages posted by its steps on the LCD.
+ */
+void APP_waitDisplaySequence(void)
+{
+	uint8 message;
+	uint8 sreg;
+
+	while(SEQUENCE_isBusy(&g_lcdSequence) || (g_pendingMessage != MESSAGE_NONE))
 	{
+		sreg = SREG;
+		cli();
+		message = g_pendingMessage;
+		g_pendingMessage = MESSAGE_NONE;
+		SREG = sreg;
+
+		if(message == MESSAGE_NONE)
+		{
+			continue;
+		}
+
 		LCD_clearScreen();
-		LCD_displayStringRowColumn(0, 5, "ERROR");
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 2)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 3)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 4)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 5)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 6)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 7)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 62500, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 62500 = 8 seconds
-	}
-	else if(g_ticks_LCD == 8)
-	{
-		Timer1_deInit();
-		startTimer1(0x00, 3125, F_CPU_DIVIDE_1024, CTC_OCR1A, APP_wrongPassword);  // 3125 = 4 seconds
-	}
-}
 
+		switch(message)
+		{
+		case MESSAGE_UNLOCKING:
+			LCD_displayStringRowColumn(0, 4, "Door is");
+			LCD_displayStringRowColumn(1, 3, "Unlocking");
+			break;
+
+		case MESSAGE_LOCKING:
+			LCD_displayStringRowColumn(0, 0, "Door is Locking");
+			break;
+
+		case MESSAGE_ERROR:
+			LCD_displayStringRowColumn(0, 5, "ERROR");
+			break;
 
+		default: /* MESSAGE_CLEAR */
+			break;
+		}
+	}
+}
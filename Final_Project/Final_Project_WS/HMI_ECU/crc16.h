@@ -0,0 +1,64 @@
+ /******************************************************************************
+ *
+ * Module: CRC16
+ *
+ * File Name: crc16.h
+ *
+ * Description: Header file for the table driven CRC-16 calculation
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection and no final XOR.
+ * The CRC of the ASCII string "123456789" is 0x29B1.
+ */
+#define CRC16_INITIAL_VALUE            0xFFFF
+
+/*
+ * The programmer has to uncomment only one of these 2 #defines:
+ * CRC16_BYTE_TABLE   : 256 entries table in the flash (512 bytes), one table lookup for each byte,
+ *                      roughly 20 cycles per byte.
+ * CRC16_NIBBLE_TABLE : 16 entries table in the flash (32 bytes), two table lookups for each byte,
+ *                      roughly 40 cycles per byte.
+ * The table sizes follow from the entries, the cycles are estimates counted by hand from the C code
+ * and were not measured. avr-size and a cycle count in the simulator give the real figures of a build
+ * (the -O0 Debug build takes longer than -Os).
+ */
+#define CRC16_BYTE_TABLE
+/* #define CRC16_NIBBLE_TABLE */
+
+#if(defined(CRC16_BYTE_TABLE) && defined(CRC16_NIBBLE_TABLE)) || (!defined(CRC16_BYTE_TABLE) && !defined(CRC16_NIBBLE_TABLE))
+
+#error "Only one of CRC16_BYTE_TABLE and CRC16_NIBBLE_TABLE should be defined"
+
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Update the required CRC value with one more byte.
+ */
+uint16 CRC16_updateByte(uint16 crc, uint8 data);
+
+/*
+ * Description :
+ * Update the required CRC value with a buffer of bytes.
+ * Start with CRC16_INITIAL_VALUE to get the CRC of the buffer.
+ */
+uint16 CRC16_update(uint16 crc, const uint8 *data, uint8 length);
+
+#endif /* CRC16_H_ */
@@ -0,0 +1,792 @@
+ /******************************************************************************
+ *
+ * Module: LINK
+ *
+ * File Name: link.c
+ *
+ * Description: Source file for the frames link layer between the two ECUs over the UART
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include "link.h"
+#include "uart.h"
+#include "crc16.h"
+#include "timer2.h"
+#include <util/delay.h> /* For the delay functions */
+
+/* The encoded frame (COBS code byte and delimiter added) must fit in place in the UART Rx buffer */
+#if((LINK_MAX_FRAME_SIZE + 2) > UART_RX_FRAME_MAX_SIZE)
+
+#error "LINK max frame size does not fit in the UART Rx frame max size"
+
+#endif
+
+#if(LINK_STATISTIC_SIZE > LINK_MAX_REPLY_SIZE)
+
+#error "LINK statistic reply does not fit in the LINK max reply size"
+
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* States of a place in the window */
+#define LINK_REQUEST_FREE              0
+#define LINK_REQUEST_WAITING           1
+#define LINK_REQUEST_REPLIED           2
+#define LINK_REQUEST_FAILED            3
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/*
+ * A request waiting for its reply, it is kept in the window place (sequence % LINK_WINDOW_SIZE)
+ * with its payload to be sent again if the reply is not received in time.
+ */
+typedef struct
+{
+	uint8 state;
+	uint8 type;
+	uint8 sequence;
+	uint8 retries;
+	uint16 sentTick;     /* In milliseconds for the reply timeout */
+	uint16 sentFineTick; /* In TIMER2_FINE_TICK_US units for the round trip time */
+	uint8 payloadLength;
+	uint8 payload[LINK_MAX_PAYLOAD_SIZE];
+	uint8 length;
+	uint8 reply[LINK_MAX_REPLY_SIZE];
+}LINK_RequestType;
+
+/* The last reply sent in a window place, sent again if its request is received again */
+typedef struct
+{
+	boolean valid;
+	uint8 type;
+	uint8 sequence;
+	uint8 length;
+	uint8 payload[LINK_MAX_REPLY_SIZE];
+}LINK_ReplyType;
+
+/* Link layer counters, the round trip times are in TIMER2_FINE_TICK_US units */
+typedef struct
+{
+	uint16 framesIn;
+	uint16 framesOut;
+	uint16 crcErrors;
+	uint16 lengthErrors;
+	uint16 retransmissions;
+	uint16 failedRequests;
+	uint16 roundTrips;
+	uint16 minRoundTrip;
+	uint16 maxRoundTrip;
+	uint32 totalRoundTrip;
+}LINK_StatisticsType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Baud rates which can be negotiated, from the slowest to the fastest, the first one is the default */
+static const UART_BaudRate g_baudRates[] = {LINK_DEFAULT_BAUD_RATE, 19200, 38400, 76800, 125000, 250000};
+
+#define LINK_BAUD_RATES_COUNT          (sizeof(g_baudRates) / sizeof(g_baudRates[0]))
+
+/* The frame format given to LINK_init, only its baud rate is changed by the negotiation */
+static UART_ConfigType g_UART_Configurations;
+
+/* Requests waiting for their replies */
+static LINK_RequestType g_window[LINK_WINDOW_SIZE];
+
+/* Sequence number of the next request, it never takes LINK_CONTROL_SEQUENCE */
+static uint8 g_nextSequence = LINK_CONTROL_SEQUENCE + 1;
+
+/* Replies sent to the other ECU requests */
+static LINK_ReplyType g_replies[LINK_WINDOW_SIZE];
+
+static LINK_StatisticsType g_statistics;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Check the length and the CRC of a received COBS frame and fill the frame view.
+ */
+static LINK_Status LINK_checkFrame(const uint8 *data, uint8 size, LINK_FrameType *frame);
+
+/*
+ * Description :
+ * Wait for the next frame like LINK_receiveFrame but not more than the required time.
+ */
+static LINK_Status LINK_receiveFrameTimeout(LINK_FrameType *frame, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Return a mask of the baud rates (bit i for g_baudRates[i]) which have an accepted error.
+ */
+static uint8 LINK_supportedBaudRates(void);
+
+/*
+ * Description :
+ * Re-initialize the UART with the same frame format at the required baud rate.
+ */
+static void LINK_setBaudRate(UART_BaudRate baudRate);
+
+/*
+ * Description :
+ * Send the frame of a request in the window and start its reply timeout.
+ */
+static void LINK_sendRequest(LINK_RequestType *request);
+
+/*
+ * Description :
+ * Drop all the waiting requests and the kept replies at the start of a new session.
+ */
+static void LINK_resetSession(void);
+
+/*
+ * Description :
+ * Add the round trip time of an answered request to the statistics.
+ */
+static void LINK_addRoundTrip(uint16 roundTrip);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the UART with the required frame format at the default baud rate and start
+ * the Timer2 tick used for the timeouts.
+ * The frame format is kept to be used again when the baud rate is changed.
+ */
+void LINK_init(const UART_ConfigType *Config_Ptr)
+{
+	g_UART_Configurations = *Config_Ptr;
+	LINK_setBaudRate(LINK_DEFAULT_BAUD_RATE);
+	Timer2_startTick();
+}
+
+/*
+ * Description :
+ * Offer the supported baud rates to the other ECU then switch both ECUs to the fastest common one.
+ * The new baud rate is used only after a confirm frame goes and comes back at it, otherwise both
+ * ECUs go back to the default baud rate. The other ECU keeps it only after the commit frame sent
+ * at the end, if this frame is lost the next request fails and the link is negotiated again from
+ * the default baud rate. Returns the baud rate in use.
+ * It starts again from the default baud rate and drops all the waiting requests, so it is also
+ * used to get the link back after a request fails (e.g. the other ECU is reset).
+ */
+UART_BaudRate LINK_negotiateBaudRate(void)
+{
+	LINK_FrameType reply;
+	uint8 supported = LINK_supportedBaudRates();
+	uint8 selected;
+
+	LINK_resetSession();
+	if(g_UART_Configurations.baudRate != LINK_DEFAULT_BAUD_RATE)
+	{
+		UART_flush();
+		LINK_setBaudRate(LINK_DEFAULT_BAUD_RATE);
+	}
+
+	/* Keep offering until the other ECU is up and answers with the selected baud rate */
+	while(1)
+	{
+		LINK_sendFrame(LINK_BAUD_OFFER, LINK_CONTROL_SEQUENCE, &supported, 1);
+		if(LINK_OK == LINK_receiveFrameTimeout(&reply, LINK_BAUD_OFFER_TIMEOUT_MS))
+		{
+			if((reply.type == LINK_BAUD_OFFER) && (reply.length == 1) && (reply.payload[0] < LINK_BAUD_RATES_COUNT))
+			{
+				selected = reply.payload[0];
+				LINK_releaseFrame();
+				break;
+			}
+			LINK_releaseFrame();
+		}
+	}
+
+	if(g_baudRates[selected] == g_UART_Configurations.baudRate)
+	{
+		return g_UART_Configurations.baudRate;
+	}
+
+	/* Give the other ECU the time to finish sending its reply and switch */
+	_delay_ms(1);
+	LINK_setBaudRate(g_baudRates[selected]);
+
+	LINK_sendFrame(LINK_BAUD_CONFIRM, LINK_CONTROL_SEQUENCE, &selected, 1);
+	if(LINK_OK == LINK_receiveFrameTimeout(&reply, LINK_BAUD_CONFIRM_TIMEOUT_MS))
+	{
+		if(reply.type == LINK_BAUD_CONFIRM)
+		{
+			LINK_releaseFrame();
+
+			/* The confirm is the proof that the other ECU switched, the commit is its proof of this ECU */
+			LINK_sendFrame(LINK_BAUD_COMMIT, LINK_CONTROL_SEQUENCE, &selected, 1);
+			return g_UART_Configurations.baudRate;
+		}
+		LINK_releaseFrame();
+	}
+
+	/* The new baud rate does not work, go back to the default one like the other ECU */
+	UART_flush();
+	LINK_setBaudRate(LINK_DEFAULT_BAUD_RATE);
+	return g_UART_Configurations.baudRate;
+}
+
+/*
+ * Description :
+ * Answer a LINK_BAUD_OFFER frame received from the other ECU by selecting the fastest common baud rate
+ * and switching to it if it is confirmed then committed by the other ECU, otherwise it goes back to the
+ * default baud rate where the other ECU sends its next offer. The offer frame is released by this function.
+ * The kept replies are dropped as the other ECU starts a new session.
+ */
+void LINK_answerBaudRateOffer(const LINK_FrameType *offer)
+{
+	LINK_FrameType confirm;
+	uint8 common = 0;
+	uint8 selected = 0;
+	uint8 i;
+
+	LINK_resetSession();
+
+	if(offer->length == 1)
+	{
+		common = offer->payload[0] & LINK_supportedBaudRates();
+	}
+	LINK_releaseFrame();
+
+	/* Select the fastest common baud rate, the default one is always supported */
+	for(i = 0; i < LINK_BAUD_RATES_COUNT; i++)
+	{
+		if(common & (1 << i))
+		{
+			selected = i;
+		}
+	}
+
+	LINK_sendFrame(LINK_BAUD_OFFER, LINK_CONTROL_SEQUENCE, &selected, 1);
+
+	if(g_baudRates[selected] == g_UART_Configurations.baudRate)
+	{
+		return;
+	}
+
+	/* The reply must be completely sent at the old baud rate before switching */
+	UART_flush();
+	LINK_setBaudRate(g_baudRates[selected]);
+
+	if(LINK_OK == LINK_receiveFrameTimeout(&confirm, LINK_BAUD_CONFIRM_TIMEOUT_MS))
+	{
+		if(confirm.type == LINK_BAUD_CONFIRM)
+		{
+			LINK_releaseFrame();
+			LINK_sendFrame(LINK_BAUD_CONFIRM, LINK_CONTROL_SEQUENCE, &selected, 1);
+
+			/*
+			 * The new baud rate is kept only if the other ECU received this confirm, otherwise it is back
+			 * at the default baud rate and its next offer would never be understood here.
+			 */
+			if(LINK_OK == LINK_receiveFrameTimeout(&confirm, LINK_BAUD_CONFIRM_TIMEOUT_MS))
+			{
+				if(confirm.type == LINK_BAUD_COMMIT)
+				{
+					LINK_releaseFrame();
+					return;
+				}
+				LINK_releaseFrame();
+			}
+		}
+		else
+		{
+			LINK_releaseFrame();
+		}
+	}
+
+	/* The other ECU goes back to the default baud rate too after its confirm timeout */
+	UART_flush();
+	LINK_setBaudRate(LINK_DEFAULT_BAUD_RATE);
+}
+
+/*
+ * Description :
+ * Send a request frame to the other ECU without waiting for its reply. The sequence number given
+ * to the request is returned to take its reply later. Returns FALSE if the window is full
+ * or the payload is longer than LINK_MAX_PAYLOAD_SIZE.
+ */
+boolean LINK_submitRequest(uint8 type, const uint8 *payload, uint8 length, uint8 *sequence)
+{
+	LINK_RequestType *request = &g_window[g_nextSequence & (LINK_WINDOW_SIZE - 1)];
+	uint8 i;
+
+	/* The payload does not fit the window place */
+	if(length > LINK_MAX_PAYLOAD_SIZE)
+	{
+		return FALSE;
+	}
+
+	/* The place is still used by an older request which is not finished yet */
+	if(request->state != LINK_REQUEST_FREE)
+	{
+		return FALSE;
+	}
+
+	request->state = LINK_REQUEST_WAITING;
+	request->type = type;
+	request->sequence = g_nextSequence;
+	request->retries = 0;
+	request->payloadLength = length;
+	for(i = 0; i < length; i++)
+	{
+		request->payload[i] = payload[i];
+	}
+	*sequence = g_nextSequence;
+
+	g_nextSequence++;
+	if(g_nextSequence == LINK_CONTROL_SEQUENCE)
+	{
+		g_nextSequence++;
+	}
+
+	LINK_sendRequest(request);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Take the received reply frames without waiting and keep each one with the request
+ * of the same sequence number. The requests which are not answered in time are sent again
+ * or failed after the last retry.
+ */
+void LINK_poll(void)
+{
+	LINK_FrameType reply;
+	LINK_RequestType *request;
+	uint8 i;
+
+	while(LINK_OK == LINK_receiveFrameTimeout(&reply, 0))
+	{
+		request = &g_window[reply.sequence & (LINK_WINDOW_SIZE - 1)];
+
+		/* A reply which does not match a waiting request is dropped */
+		if((request->state == LINK_REQUEST_WAITING) && (request->sequence == reply.sequence) &&
+				(request->type == reply.type) && (reply.length <= LINK_MAX_REPLY_SIZE))
+		{
+			for(i = 0; i < reply.length; i++)
+			{
+				request->reply[i] = reply.payload[i];
+			}
+			request->length = reply.length;
+			request->state = LINK_REQUEST_REPLIED;
+
+			/* A reply after a retry may belong to any of the sent copies, so it is not timed */
+			if(request->retries == 0)
+			{
+				LINK_addRoundTrip(Timer2_getFineTicks() - request->sentFineTick);
+			}
+		}
+
+		LINK_releaseFrame();
+	}
+
+	for(i = 0; i < LINK_WINDOW_SIZE; i++)
+	{
+		request = &g_window[i];
+		if((request->state == LINK_REQUEST_WAITING) && Timer2_isElapsed(request->sentTick, LINK_REPLY_TIMEOUT_MS))
+		{
+			if(request->retries < LINK_MAX_RETRIES)
+			{
+				request->retries++;
+				g_statistics.retransmissions++;
+				LINK_sendRequest(request);
+			}
+			else
+			{
+				request->state = LINK_REQUEST_FAILED;
+				g_statistics.failedRequests++;
+			}
+		}
+	}
+}
+
+/*
+ * Description :
+ * Take the reply of the required request if it is received and free its place in the window.
+ * Returns LINK_PENDING if the reply is not received yet, or LINK_TIMEOUT if the request failed.
+ */
+LINK_Status LINK_getReply(uint8 sequence, uint8 *reply, uint8 *length)
+{
+	LINK_RequestType *request = &g_window[sequence & (LINK_WINDOW_SIZE - 1)];
+	uint8 i;
+
+	/* The request is already dropped by a new session */
+	if((request->sequence != sequence) || (request->state == LINK_REQUEST_FREE))
+	{
+		return LINK_TIMEOUT;
+	}
+
+	if(request->state == LINK_REQUEST_WAITING)
+	{
+		return LINK_PENDING;
+	}
+
+	if(request->state == LINK_REQUEST_FAILED)
+	{
+		request->state = LINK_REQUEST_FREE;
+		return LINK_TIMEOUT;
+	}
+
+	for(i = 0; i < request->length; i++)
+	{
+		reply[i] = request->reply[i];
+	}
+	*length = request->length;
+	request->state = LINK_REQUEST_FREE;
+
+	return LINK_OK;
+}
+
+/*
+ * Description :
+ * Wait for the reply of the required request, not more than LINK_MAX_RECOVERY_TIME_MS.
+ * Returns LINK_OK with the reply and its length, or LINK_TIMEOUT if the request failed.
+ */
+LINK_Status LINK_waitReply(uint8 sequence, uint8 *reply, uint8 *length)
+{
+	LINK_Status status;
+
+	while(LINK_PENDING == (status = LINK_getReply(sequence, reply, length)))
+	{
+		LINK_poll();
+	}
+
+	return status;
+}
+
+/*
+ * Description :
+ * Send the reply of a received request frame to the other ECU.
+ * The reply is kept to be sent again if the same request is received again.
+ */
+void LINK_sendReply(const LINK_FrameType *request, const uint8 *payload, uint8 length)
+{
+	LINK_ReplyType *kept = &g_replies[request->sequence & (LINK_WINDOW_SIZE - 1)];
+	uint8 i;
+
+	/* A control reply is never kept, its place is shared with the kept reply of a data sequence */
+	if(request->sequence != LINK_CONTROL_SEQUENCE)
+	{
+		kept->valid = (length <= LINK_MAX_REPLY_SIZE);
+		if(kept->valid)
+		{
+			kept->type = request->type;
+			kept->sequence = request->sequence;
+			kept->length = length;
+			for(i = 0; i < length; i++)
+			{
+				kept->payload[i] = payload[i];
+			}
+		}
+	}
+
+	LINK_sendFrame(request->type, request->sequence, payload, length);
+}
+
+/*
+ * Description :
+ * Send again the kept reply if the received request is a retransmission of an answered one,
+ * so the request is not executed twice. Returns FALSE if the request is a new one.
+ */
+boolean LINK_answerRepeatedRequest(const LINK_FrameType *request)
+{
+	LINK_ReplyType *kept = &g_replies[request->sequence & (LINK_WINDOW_SIZE - 1)];
+
+	if((kept->valid == FALSE) || (kept->type != request->type) || (kept->sequence != request->sequence))
+	{
+		return FALSE;
+	}
+
+	LINK_sendFrame(kept->type, kept->sequence, kept->payload, kept->length);
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return the required statistic of this ECU link.
+ */
+uint32 LINK_getStatistic(LINK_StatisticId id)
+{
+	UART_StatisticsType UART_Statistics;
+
+	UART_getStatistics(&UART_Statistics);
+
+	switch(id)
+	{
+	case LINK_BYTES_IN:          return UART_Statistics.bytesIn;
+	case LINK_BYTES_OUT:         return UART_Statistics.bytesOut;
+	case LINK_FRAMES_IN:         return g_statistics.framesIn;
+	case LINK_FRAMES_OUT:        return g_statistics.framesOut;
+	case LINK_FRAMING_ERRORS:    return UART_Statistics.framingErrors;
+	case LINK_DATA_OVERRUNS:     return UART_Statistics.dataOverruns;
+	case LINK_PARITY_ERRORS:     return UART_Statistics.parityErrors;
+	case LINK_BUFFER_OVERFLOWS:  return UART_Statistics.bufferOverflows;
+	case LINK_CRC_ERRORS:        return g_statistics.crcErrors;
+	case LINK_LENGTH_ERRORS:     return g_statistics.lengthErrors;
+	case LINK_RETRANSMISSIONS:   return g_statistics.retransmissions;
+	case LINK_FAILED_REQUESTS:   return g_statistics.failedRequests;
+	case LINK_ROUND_TRIPS:       return g_statistics.roundTrips;
+	case LINK_MIN_ROUND_TRIP_US: return (uint32)g_statistics.minRoundTrip * TIMER2_FINE_TICK_US;
+	case LINK_MAX_ROUND_TRIP_US: return (uint32)g_statistics.maxRoundTrip * TIMER2_FINE_TICK_US;
+	case LINK_AVG_ROUND_TRIP_US:
+		if(g_statistics.roundTrips == 0)
+		{
+			return 0;
+		}
+		return (g_statistics.totalRoundTrip / g_statistics.roundTrips) * TIMER2_FINE_TICK_US;
+	default:                     return 0;
+	}
+}
+
+/*
+ * Description :
+ * Answer a LINK_GET_STATISTIC request received from the other ECU with the required statistic.
+ */
+void LINK_answerStatisticRequest(const LINK_FrameType *request)
+{
+	uint32 value = 0;
+	uint8 reply[LINK_STATISTIC_SIZE];
+
+	if(request->length == 1)
+	{
+		value = LINK_getStatistic((LINK_StatisticId)request->payload[0]);
+	}
+
+	reply[0] = (uint8)(value >> 24);
+	reply[1] = (uint8)(value >> 16);
+	reply[2] = (uint8)(value >> 8);
+	reply[3] = (uint8)value;
+
+	LINK_sendReply(request, reply, LINK_STATISTIC_SIZE);
+}
+
+/*
+ * Description :
+ * Take the required statistic of the other ECU link by a LINK_GET_STATISTIC request.
+ * Returns LINK_TIMEOUT if the other ECU does not reply.
+ */
+LINK_Status LINK_getRemoteStatistic(LINK_StatisticId id, uint32 *value)
+{
+	uint8 sequence;
+	uint8 request = id;
+	uint8 reply[LINK_MAX_REPLY_SIZE];
+	uint8 length;
+	LINK_Status status;
+
+	while(!LINK_submitRequest(LINK_GET_STATISTIC, &request, 1, &sequence))
+	{
+		LINK_poll();
+	}
+
+	status = LINK_waitReply(sequence, reply, &length);
+	if((status == LINK_OK) && (length != LINK_STATISTIC_SIZE))
+	{
+		status = LINK_LENGTH_ERROR;
+	}
+
+	if(status == LINK_OK)
+	{
+		*value = ((uint32)reply[0] << 24) | ((uint32)reply[1] << 16) | ((uint32)reply[2] << 8) | reply[3];
+	}
+
+	return status;
+}
+
+/*
+ * Description :
+ * Send one frame with the required type, sequence number and payload to the other ECU.
+ */
+void LINK_sendFrame(uint8 type, uint8 sequence, const uint8 *payload, uint8 length)
+{
+	uint8 header[LINK_HEADER_SIZE] = {type, sequence, length};
+	uint8 trailer[LINK_CRC_SIZE];
+	uint16 crc;
+
+	/* The payload is sent from the caller buffer, it is not copied in a frame buffer */
+	UART_SegmentType segments[3] = {{header, LINK_HEADER_SIZE}, {payload, length}, {trailer, LINK_CRC_SIZE}};
+
+	crc = CRC16_update(CRC16_INITIAL_VALUE, header, LINK_HEADER_SIZE);
+	crc = CRC16_update(crc, payload, length);
+	trailer[0] = (uint8)(crc >> 8);
+	trailer[1] = (uint8)crc;
+
+	UART_sendv(segments, 3);
+	g_statistics.framesOut++;
+}
+
+/*
+ * Description :
+ * Wait for the next frame from the other ECU and check its length and CRC.
+ * If LINK_OK is returned the frame must be given back by LINK_releaseFrame after using it,
+ * otherwise the frame is already dropped.
+ */
+LINK_Status LINK_receiveFrame(LINK_FrameType *frame)
+{
+	uint8 size;
+	const uint8 *data;
+
+	/* Corrupted COBS frames are dropped by the UART driver */
+	while(!UART_getFrame(&data, &size)){}
+
+	return LINK_checkFrame(data, size, frame);
+}
+
+/*
+ * Description :
+ * Give back the place of the received frame to the UART Rx buffer.
+ */
+void LINK_releaseFrame(void)
+{
+	UART_releaseFrame();
+}
+
+/*
+ * Description :
+ * Check the length and the CRC of a received COBS frame and fill the frame view.
+ */
+static LINK_Status LINK_checkFrame(const uint8 *data, uint8 size, LINK_FrameType *frame)
+{
+	uint16 crc;
+
+	if((size < (LINK_HEADER_SIZE + LINK_CRC_SIZE)) || (data[2] != (size - LINK_HEADER_SIZE - LINK_CRC_SIZE)))
+	{
+		UART_releaseFrame();
+		g_statistics.lengthErrors++;
+		return LINK_LENGTH_ERROR;
+	}
+
+	frame->type = data[0];
+	frame->sequence = data[1];
+	frame->length = data[2];
+	frame->payload = data + LINK_HEADER_SIZE;
+
+	crc = CRC16_update(CRC16_INITIAL_VALUE, data, LINK_HEADER_SIZE + frame->length);
+	if((frame->payload[frame->length] != (uint8)(crc >> 8)) || (frame->payload[frame->length + 1] != (uint8)crc))
+	{
+		UART_releaseFrame();
+		g_statistics.crcErrors++;
+		return LINK_CRC_ERROR;
+	}
+
+	g_statistics.framesIn++;
+
+	return LINK_OK;
+}
+
+/*
+ * Description :
+ * Wait for the next frame like LINK_receiveFrame but not more than the required time.
+ * (in the UART polling mode UART_getFrame waits for the frame so the time is not limited)
+ */
+static LINK_Status LINK_receiveFrameTimeout(LINK_FrameType *frame, uint16 timeout_ms)
+{
+	uint8 size;
+	const uint8 *data;
+	uint16 start = Timer2_getTicks();
+
+	while(!UART_getFrame(&data, &size))
+	{
+		if(Timer2_isElapsed(start, timeout_ms))
+		{
+			return LINK_TIMEOUT;
+		}
+	}
+
+	return LINK_checkFrame(data, size, frame);
+}
+
+/*
+ * Description :
+ * Return a mask of the baud rates (bit i for g_baudRates[i]) which have an accepted error.
+ */
+static uint8 LINK_supportedBaudRates(void)
+{
+	uint8 supported = 0;
+	uint8 i;
+	sint16 error;
+
+	for(i = 0; i < LINK_BAUD_RATES_COUNT; i++)
+	{
+		error = UART_calculateBaudRateError(g_baudRates[i]);
+		if((error <= LINK_MAX_BAUD_RATE_ERROR) && (error >= -LINK_MAX_BAUD_RATE_ERROR))
+		{
+			supported |= (1 << i);
+		}
+	}
+
+	return supported;
+}
+
+/*
+ * Description :
+ * Re-initialize the UART with the same frame format at the required baud rate.
+ */
+static void LINK_setBaudRate(UART_BaudRate baudRate)
+{
+	g_UART_Configurations.baudRate = baudRate;
+	UART_init(&g_UART_Configurations);
+}
+
+/*
+ * Description :
+ * Send the frame of a request in the window and start its reply timeout.
+ */
+static void LINK_sendRequest(LINK_RequestType *request)
+{
+	request->sentTick = Timer2_getTicks();
+	request->sentFineTick = Timer2_getFineTicks();
+	LINK_sendFrame(request->type, request->sequence, request->payload, request->payloadLength);
+}
+
+/*
+ * Description :
+ * Drop all the waiting requests and the kept replies at the start of a new session.
+ */
+static void LINK_resetSession(void)
+{
+	uint8 i;
+
+	for(i = 0; i < LINK_WINDOW_SIZE; i++)
+	{
+		g_window[i].state = LINK_REQUEST_FREE;
+		g_replies[i].valid = FALSE;
+	}
+}
+
+/*
+ * Description :
+ * Add the round trip time of an answered request to the statistics.
+ */
+static void LINK_addRoundTrip(uint16 roundTrip)
+{
+	if((g_statistics.roundTrips == 0) || (roundTrip < g_statistics.minRoundTrip))
+	{
+		g_statistics.minRoundTrip = roundTrip;
+	}
+	if(roundTrip > g_statistics.maxRoundTrip)
+	{
+		g_statistics.maxRoundTrip = roundTrip;
+	}
+
+	/* Stop counting before the average goes wrong by the overflow of the counter */
+	if(g_statistics.roundTrips < 0xFFFF)
+	{
+		g_statistics.roundTrips++;
+		g_statistics.totalRoundTrip += roundTrip;
+	}
+}
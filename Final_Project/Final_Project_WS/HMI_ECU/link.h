@@ -0,0 +1,227 @@
+ /******************************************************************************
+ *
+ * Module: LINK
+ *
+ * File Name: link.h
+ *
+ * Description: Header file for the frames link layer between the two ECUs over the UART
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include "std_types.h"
+#include "uart.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Frame format, the whole frame is sent as one COBS frame by the UART driver
+ * so a zero byte on the line always marks the end of a frame:
+ * | TYPE | SEQUENCE | LENGTH | PAYLOAD (LENGTH bytes) | CRC (high byte) | CRC (low byte) |
+ * CRC is the CRC-16 of the TYPE, SEQUENCE, LENGTH and PAYLOAD bytes.
+ * A reply frame has the same TYPE and SEQUENCE of its request frame.
+ */
+#define LINK_HEADER_SIZE               3
+#define LINK_CRC_SIZE                  2
+#define LINK_MAX_PAYLOAD_SIZE          16
+#define LINK_MAX_FRAME_SIZE            (LINK_HEADER_SIZE + LINK_MAX_PAYLOAD_SIZE + LINK_CRC_SIZE)
+
+/*
+ * Number of requests which can wait for their replies at the same time (sliding window),
+ * it must be a power of two. Sequence number 0 is used only by the link layer own frames.
+ */
+#define LINK_WINDOW_SIZE               4
+#define LINK_CONTROL_SEQUENCE          0
+
+#if((LINK_WINDOW_SIZE & (LINK_WINDOW_SIZE - 1)) != 0)
+
+#error "LINK window size should be a power of two"
+
+#endif
+
+/* Largest reply payload kept for a request until it is taken by the application */
+#define LINK_MAX_REPLY_SIZE            4
+
+/* Frame types used by the link layer itself, the application commands must not use them */
+#define LINK_BAUD_OFFER                0xB0
+#define LINK_BAUD_CONFIRM              0xB1
+#define LINK_BAUD_COMMIT               0xB3
+
+/*
+ * Diagnostic request, its payload is one LINK_StatisticId and its reply is the
+ * 4 bytes value of this statistic in the replying ECU (high byte first).
+ */
+#define LINK_GET_STATISTIC             0xB2
+#define LINK_STATISTIC_SIZE            4
+
+/* Both ECUs start with this baud rate and go back to it if the negotiation fails */
+#define LINK_DEFAULT_BAUD_RATE         9600
+
+/* A baud rate is supported only if its error is not more than 2.00% (in hundredths of a percent) */
+#define LINK_MAX_BAUD_RATE_ERROR       200
+
+/* Time to wait for the reply of an offer, then the offer is sent again */
+#define LINK_BAUD_OFFER_TIMEOUT_MS     100
+
+/* Time to wait for the confirm (or commit) frame sent at the new baud rate before going back to the default one */
+#define LINK_BAUD_CONFIRM_TIMEOUT_MS   100
+
+/*
+ * A request is sent again with the same sequence number if its reply is not received in
+ * LINK_REPLY_TIMEOUT_MS, up to LINK_MAX_RETRIES times, then it fails with LINK_TIMEOUT.
+ * So a dead link is detected after LINK_MAX_RECOVERY_TIME_MS at most.
+ */
+#define LINK_REPLY_TIMEOUT_MS          100
+#define LINK_MAX_RETRIES               3
+#define LINK_MAX_RECOVERY_TIME_MS      ((LINK_MAX_RETRIES + 1) * LINK_REPLY_TIMEOUT_MS)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	LINK_OK, LINK_LENGTH_ERROR, LINK_CRC_ERROR, LINK_TIMEOUT, LINK_PENDING
+}LINK_Status;
+
+/* Statistics of an ECU link, the round trip times are of the requests answered without a retry */
+typedef enum
+{
+	LINK_BYTES_IN, LINK_BYTES_OUT, LINK_FRAMES_IN, LINK_FRAMES_OUT, LINK_FRAMING_ERRORS, LINK_DATA_OVERRUNS,
+	LINK_PARITY_ERRORS, LINK_BUFFER_OVERFLOWS, LINK_CRC_ERRORS, LINK_LENGTH_ERRORS, LINK_RETRANSMISSIONS,
+	LINK_FAILED_REQUESTS, LINK_ROUND_TRIPS, LINK_MIN_ROUND_TRIP_US, LINK_AVG_ROUND_TRIP_US, LINK_MAX_ROUND_TRIP_US,
+	LINK_STATISTICS_COUNT
+}LINK_StatisticId;
+
+/* A view of a received frame, the payload is not copied out of the UART Rx buffer */
+typedef struct
+{
+	uint8 type;
+	uint8 sequence;
+	uint8 length;
+	const uint8 *payload; /* Valid until LINK_releaseFrame is called */
+}LINK_FrameType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the UART with the required frame format at the default baud rate and start
+ * the Timer2 tick used for the timeouts.
+ * The frame format is kept to be used again when the baud rate is changed.
+ */
+void LINK_init(const UART_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Offer the supported baud rates to the other ECU then switch both ECUs to the fastest common one.
+ * The new baud rate is used only after a confirm frame goes and comes back at it, otherwise both
+ * ECUs go back to the default baud rate. The other ECU keeps it only after the commit frame sent
+ * at the end, if this frame is lost the next request fails and the link is negotiated again from
+ * the default baud rate. Returns the baud rate in use.
+ * It starts again from the default baud rate and drops all the waiting requests, so it is also
+ * used to get the link back after a request fails (e.g. the other ECU is reset).
+ */
+UART_BaudRate LINK_negotiateBaudRate(void);
+
+/*
+ * Description :
+ * Answer a LINK_BAUD_OFFER frame received from the other ECU by selecting the fastest common baud rate
+ * and switching to it if it is confirmed then committed by the other ECU, otherwise it goes back to the
+ * default baud rate where the other ECU sends its next offer. The offer frame is released by this function.
+ * The kept replies are dropped as the other ECU starts a new session.
+ */
+void LINK_answerBaudRateOffer(const LINK_FrameType *offer);
+
+/*
+ * Description :
+ * Send a request frame to the other ECU without waiting for its reply. The sequence number given
+ * to the request is returned to take its reply later. Returns FALSE if the window is full
+ * or the payload is longer than LINK_MAX_PAYLOAD_SIZE.
+ */
+boolean LINK_submitRequest(uint8 type, const uint8 *payload, uint8 length, uint8 *sequence);
+
+/*
+ * Description :
+ * Take the received reply frames without waiting and keep each one with the request
+ * of the same sequence number. The requests which are not answered in time are sent again
+ * or failed after the last retry.
+ */
+void LINK_poll(void);
+
+/*
+ * Description :
+ * Take the reply of the required request if it is received and free its place in the window.
+ * Returns LINK_PENDING if the reply is not received yet, or LINK_TIMEOUT if the request failed.
+ */
+LINK_Status LINK_getReply(uint8 sequence, uint8 *reply, uint8 *length);
+
+/*
+ * Description :
+ * Wait for the reply of the required request, not more than LINK_MAX_RECOVERY_TIME_MS.
+ * Returns LINK_OK with the reply and its length, or LINK_TIMEOUT if the request failed.
+ */
+LINK_Status LINK_waitReply(uint8 sequence, uint8 *reply, uint8 *length);
+
+/*
+ * Description :
+ * Send the reply of a received request frame to the other ECU.
+ * The reply is kept to be sent again if the same request is received again.
+ */
+void LINK_sendReply(const LINK_FrameType *request, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Send again the kept reply if the received request is a retransmission of an answered one,
+ * so the request is not executed twice. Returns FALSE if the request is a new one.
+ */
+boolean LINK_answerRepeatedRequest(const LINK_FrameType *request);
+
+/*
+ * Description :
+ * Return the required statistic of this ECU link.
+ */
+uint32 LINK_getStatistic(LINK_StatisticId id);
+
+/*
+ * Description :
+ * Answer a LINK_GET_STATISTIC request received from the other ECU with the required statistic.
+ */
+void LINK_answerStatisticRequest(const LINK_FrameType *request);
+
+/*
+ * Description :
+ * Take the required statistic of the other ECU link by a LINK_GET_STATISTIC request.
+ * Returns LINK_TIMEOUT if the other ECU does not reply.
+ */
+LINK_Status LINK_getRemoteStatistic(LINK_StatisticId id, uint32 *value);
+
+/*
+ * Description :
+ * Send one frame with the required type, sequence number and payload to the other ECU.
+ */
+void LINK_sendFrame(uint8 type, uint8 sequence, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Wait for the next frame from the other ECU and check its length and CRC.
+ * If LINK_OK is returned the frame must be given back by LINK_releaseFrame after using it,
+ * otherwise the frame is already dropped.
+ */
+LINK_Status LINK_receiveFrame(LINK_FrameType *frame);
+
+/*
+ * Description :
+ * Give back the place of the received frame to the UART Rx buffer.
+ */
+void LINK_releaseFrame(void);
+
+#endif /* LINK_H_ */
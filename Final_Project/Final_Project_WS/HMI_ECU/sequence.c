@@ -0,0 +1,239 @@
+ /******************************************************************************
+ *
+ * Module: Sequence
+ *
+ * File Name: sequence.c
+ *
+ * Description: Source file for the timed sequences engine, it runs the steps of a constant
+ * table in the flash memory one after the other on the software timers
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "sequence.h"
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Run the steps from the current one until a step with a duration is started or the sequence is finished.
+ */
+static void SEQUENCE_runSteps(SEQUENCE_Type *sequence);
+
+/*
+ * Description :
+ * Call-back function of the software timer of a step, it runs in the Timer1 ISR.
+ */
+static void SEQUENCE_stepEnd(void *context);
+
+/*
+ * Description :
+ * Set the final state of a sequence then call its call-back function.
+ */
+static void SEQUENCE_end(SEQUENCE_Type *sequence, SEQUENCE_State state);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start a sequence of count steps from the required table, the action of the first step is called at once
+ * then the next steps are run by the software timer ISR. The call-back function is called after the duration
+ * of the last step with the state SEQUENCE_FINISHED, or with SEQUENCE_ABORTED if a step timer cannot be started.
+ * Returns FALSE if the sequence is already running or paused.
+ */
+boolean SEQUENCE_start(SEQUENCE_Type *sequence, const SEQUENCE_StepType *steps, uint8 count,
+		void (*callBack)(SEQUENCE_Type *sequence))
+{
+	if(SEQUENCE_isBusy(sequence))
+	{
+		return FALSE;
+	}
+
+	sequence->steps = steps;
+	sequence->count = count;
+	sequence->callBack = callBack;
+	sequence->current = 0;
+	sequence->timer = SWTIMER_INVALID_ID;
+	sequence->state = SEQUENCE_RUNNING;
+
+	SEQUENCE_runSteps(sequence);
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Stop the time of the running step, its action is not undone. Returns FALSE if the sequence is not running.
+ */
+boolean SEQUENCE_pause(SEQUENCE_Type *sequence)
+{
+	uint8 sreg = SREG;
+
+	/* The step must not end in the ISR between reading its time left and cancelling its timer */
+	cli();
+
+	if((sequence->state != SEQUENCE_RUNNING) || (sequence->timer == SWTIMER_INVALID_ID))
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+
+	sequence->remaining_ms = SWTIMER_getRemaining(sequence->timer);
+	SWTIMER_cancel(sequence->timer);
+	sequence->timer = SWTIMER_INVALID_ID;
+	sequence->state = SEQUENCE_PAUSED;
+
+	SREG = sreg;
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Continue a paused sequence with the time left of its step. Returns FALSE if the sequence is not paused.
+ */
+boolean SEQUENCE_resume(SEQUENCE_Type *sequence)
+{
+	if(sequence->state != SEQUENCE_PAUSED)
+	{
+		return FALSE;
+	}
+
+	sequence->state = SEQUENCE_RUNNING;
+	sequence->timer = SWTIMER_start(sequence->remaining_ms, SEQUENCE_stepEnd, sequence);
+
+	/* A sequence which cannot wait for its step is not left running for ever */
+	if(sequence->timer == SWTIMER_INVALID_ID)
+	{
+		SEQUENCE_end(sequence, SEQUENCE_ABORTED);
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Stop a running or paused sequence without running its next steps, the call-back function is called
+ * with the state SEQUENCE_ABORTED.
+ */
+void SEQUENCE_abort(SEQUENCE_Type *sequence)
+{
+	uint8 sreg = SREG;
+	boolean busy;
+
+	cli();
+
+	busy = SEQUENCE_isBusy(sequence);
+	if(busy)
+	{
+		SWTIMER_cancel(sequence->timer);
+		sequence->timer = SWTIMER_INVALID_ID;
+		sequence->state = SEQUENCE_ABORTED;
+	}
+
+	SREG = sreg;
+
+	/* The call-back function is called outside the critical section */
+	if(busy && (sequence->callBack != NULL_PTR))
+	{
+		(*sequence->callBack)(sequence);
+	}
+}
+
+/*
+ * Description :
+ * Return the index of the running (or paused) step in the table, or SEQUENCE_NO_STEP.
+ */
+uint8 SEQUENCE_getCurrentStep(const SEQUENCE_Type *sequence)
+{
+	uint8 sreg = SREG;
+	uint8 step = SEQUENCE_NO_STEP;
+
+	cli();
+	if(SEQUENCE_isBusy(sequence))
+	{
+		step = sequence->current;
+	}
+	SREG = sreg;
+
+	return step;
+}
+
+/*
+ * Description :
+ * Return TRUE if the sequence is running or paused.
+ */
+boolean SEQUENCE_isBusy(const SEQUENCE_Type *sequence)
+{
+	return (sequence->state == SEQUENCE_RUNNING) || (sequence->state == SEQUENCE_PAUSED);
+}
+
+/*
+ * Description :
+ * Run the steps from the current one until a step with a duration is started or the sequence is finished.
+ */
+static void SEQUENCE_runSteps(SEQUENCE_Type *sequence)
+{
+	SEQUENCE_StepType step;
+
+	while(sequence->current < sequence->count)
+	{
+		/* The table is in the flash memory, the step is copied to the RAM */
+		memcpy_P(&step, &sequence->steps[sequence->current], sizeof(SEQUENCE_StepType));
+
+		if(step.action != NULL_PTR)
+		{
+			(*step.action)(step.argument);
+		}
+
+		if(step.duration_ms != 0)
+		{
+			sequence->timer = SWTIMER_start(step.duration_ms, SEQUENCE_stepEnd, sequence);
+			if(sequence->timer == SWTIMER_INVALID_ID)
+			{
+				SEQUENCE_end(sequence, SEQUENCE_ABORTED);
+			}
+			return;
+		}
+
+		sequence->current++;
+	}
+
+	SEQUENCE_end(sequence, SEQUENCE_FINISHED);
+}
+
+/*
+ * Description :
+ * Call-back function of the software timer of a step, it runs in the Timer1 ISR.
+ */
+static void SEQUENCE_stepEnd(void *context)
+{
+	SEQUENCE_Type *sequence = (SEQUENCE_Type *)context;
+
+	sequence->timer = SWTIMER_INVALID_ID;
+	sequence->current++;
+	SEQUENCE_runSteps(sequence);
+}
+
+/*
+ * Description :
+ * Set the final state of a sequence then call its call-back function.
+ */
+static void SEQUENCE_end(SEQUENCE_Type *sequence, SEQUENCE_State state)
+{
+	/* The state is set before the call-back function so it can start the sequence again */
+	sequence->state = state;
+
+	if(sequence->callBack != NULL_PTR)
+	{
+		(*sequence->callBack)(sequence);
+	}
+}
@@ -0,0 +1,105 @@
+ /******************************************************************************
+ *
+ * Module: Sequence
+ *
+ * File Name: sequence.h
+ *
+ * Description: Header file for the timed sequences engine, it runs the steps of a constant
+ * table in the flash memory one after the other on the software timers
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef SEQUENCE_H_
+#define SEQUENCE_H_
+
+#include "std_types.h"
+#include "swtimer.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Returned by SEQUENCE_getCurrentStep if the sequence is not running */
+#define SEQUENCE_NO_STEP               0xFF
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/*
+ * A step calls its action function with its argument then waits for its duration before the next step.
+ * The actions of the steps after the first one run in the Timer1 ISR so they must be short and must not
+ * wait (e.g. no LCD writes), a long work is posted by the action and done by the main loop.
+ */
+typedef struct
+{
+	void (*action)(uint8 argument); /* Can be NULL_PTR for a step which only waits */
+	uint8 argument;
+	uint16 duration_ms;             /* 0 to start the next step at once */
+}SEQUENCE_StepType;
+
+/* A sequence in a zero initialized variable is idle */
+typedef enum
+{
+	SEQUENCE_IDLE, SEQUENCE_RUNNING, SEQUENCE_PAUSED, SEQUENCE_FINISHED, SEQUENCE_ABORTED
+}SEQUENCE_State;
+
+typedef struct SEQUENCE_Sequence
+{
+	const SEQUENCE_StepType *steps; /* Table in the flash memory (PROGMEM) */
+	uint8 count;
+	void (*callBack)(struct SEQUENCE_Sequence *sequence); /* Called when finished or aborted, can be NULL_PTR */
+	volatile uint8 current;         /* Used by the engine */
+	volatile SEQUENCE_State state;
+	uint16 remaining_ms;            /* Time left of the paused step */
+	SWTIMER_IdType timer;
+}SEQUENCE_Type;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start a sequence of count steps from the required table, the action of the first step is called at once
+ * then the next steps are run by the software timer ISR. The call-back function is called after the duration
+ * of the last step with the state SEQUENCE_FINISHED, or with SEQUENCE_ABORTED if a step timer cannot be started.
+ * Returns FALSE if the sequence is already running or paused.
+ */
+boolean SEQUENCE_start(SEQUENCE_Type *sequence, const SEQUENCE_StepType *steps, uint8 count,
+		void (*callBack)(SEQUENCE_Type *sequence));
+
+/*
+ * Description :
+ * Stop the time of the running step, its action is not undone. Returns FALSE if the sequence is not running.
+ */
+boolean SEQUENCE_pause(SEQUENCE_Type *sequence);
+
+/*
+ * Description :
+ * Continue a paused sequence with the time left of its step. Returns FALSE if the sequence is not paused.
+ */
+boolean SEQUENCE_resume(SEQUENCE_Type *sequence);
+
+/*
+ * Description :
+ * Stop a running or paused sequence without running its next steps, the call-back function is called
+ * with the state SEQUENCE_ABORTED.
+ */
+void SEQUENCE_abort(SEQUENCE_Type *sequence);
+
+/*
+ * Description :
+ * Return the index of the running (or paused) step in the table, or SEQUENCE_NO_STEP.
+ */
+uint8 SEQUENCE_getCurrentStep(const SEQUENCE_Type *sequence);
+
+/*
+ * Description :
+ * Return TRUE if the sequence is running or paused.
+ */
+boolean SEQUENCE_isBusy(const SEQUENCE_Type *sequence);
+
+#endif /* SEQUENCE_H_ */
@@ -0,0 +1,88 @@
+ /******************************************************************************
+ *
+ * Module: Software Timer
+ *
+ * File Name: swtimer.h
+ *
+ * Description: Header file for the software timers service, many one-shot timers
+ * share the fixed 1 millisecond tick of Timer1
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef SWTIMER_H_
+#define SWTIMER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Timers which can run at the same time */
+#define SWTIMER_MAX_TIMERS             4
+
+/* Returned by SWTIMER_start if all the timers are running */
+#define SWTIMER_INVALID_ID             0xFF
+
+/* Period of the Timer1 tick, its prescaler and compare value are found by Timer1_startMs */
+#define SWTIMER_TICK_MS                1
+
+#if(SWTIMER_MAX_TIMERS >= SWTIMER_INVALID_ID)
+
+#error "Too many software timers for the 8-bit timer ID"
+
+#endif
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef uint8 SWTIMER_IdType;
+
+/* Called from the Timer1 ISR when the timer expires, with the context given to SWTIMER_start */
+typedef void (*SWTIMER_CallBackType)(void *context);
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the 1 millisecond tick of Timer1, all the timers are stopped.
+ * The global interrupt enable bit (I-bit) must be set in the application.
+ */
+void SWTIMER_init(void);
+
+/*
+ * Description :
+ * Start a one-shot timer which calls the call-back function after the required number of milliseconds
+ * (1 to 65535), it may be up to 1 millisecond early as the first tick comes at any time after the start.
+ * It can be called from a call-back function to start the next timer of a sequence.
+ * Returns the ID of the timer or SWTIMER_INVALID_ID if all the timers are running.
+ */
+SWTIMER_IdType SWTIMER_start(uint16 duration_ms, SWTIMER_CallBackType callBack, void *context);
+
+/*
+ * Description :
+ * Stop a running timer without calling its call-back function.
+ * Returns FALSE if the timer is not running (e.g. it is already expired).
+ * The ID of an expired timer is given again to a new timer so it must not be kept after the expiry.
+ */
+boolean SWTIMER_cancel(SWTIMER_IdType id);
+
+/*
+ * Description :
+ * Return TRUE if the timer is started and not expired or cancelled yet.
+ */
+boolean SWTIMER_isRunning(SWTIMER_IdType id);
+
+/*
+ * Description :
+ * Return the milliseconds left before a running timer expires (the current tick counts as a whole one),
+ * or 0 if the timer is not running.
+ */
+uint16 SWTIMER_getRemaining(SWTIMER_IdType id);
+
+#endif /* SWTIMER_H_ */
@@ -0,0 +1,110 @@
+ /******************************************************************************
+ *
+ * Module: Timer2
+ *
+ * File Name: timer2.c
+ *
+ * Description: Source file for the Timer2 milliseconds tick driver
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "timer2.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Milliseconds since the tick is started, written only by the compare match ISR */
+static volatile uint16 g_ticks = 0;
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(TIMER2_COMP_vect)
+{
+	g_ticks++;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the milliseconds tick, calling it again does not reset the tick counter.
+ * The global interrupt enable bit (I-bit) must be set in the application.
+ */
+void Timer2_startTick(void)
+{
+	TCNT2 = 0;
+	OCR2 = TIMER2_COMPARE_VALUE;
+
+	/*
+	 * Configure Timer2 Control Register:
+	 * 1. Non PWM mode FOC2=1
+	 * 2. CTC Mode WGM21=1 & WGM20=0
+	 * 3. Normal port operation, OC2 disconnected COM20=0 & COM21=0
+	 * 4. clock = F_CPU/64 CS20=0 CS21=0 CS22=1
+	 */
+	TCCR2 = (1<<FOC2) | (1<<WGM21) | (1<<CS22);
+
+	SET_BIT(TIMSK, OCIE2);
+}
+
+/*
+ * Description :
+ * Return the number of milliseconds since the tick is started, it wraps around every 65.536 seconds.
+ */
+uint16 Timer2_getTicks(void)
+{
+	uint16 ticks;
+	uint8 sreg = SREG;
+
+	/* The 16-bit counter is read in two instructions so the ISR must not change it in between */
+	cli();
+	ticks = g_ticks;
+	SREG = sreg;
+
+	return ticks;
+}
+
+/*
+ * Description :
+ * Return TRUE if the required number of milliseconds is passed since the start tick.
+ * It is correct over the wrap around as long as the duration is less than 65.536 seconds.
+ */
+boolean Timer2_isElapsed(uint16 start, uint16 duration_ms)
+{
+	return ((uint16)(Timer2_getTicks() - start) >= duration_ms);
+}
+
+/*
+ * Description :
+ * Return the time since the tick is started in TIMER2_FINE_TICK_US units, to measure short durations.
+ * It wraps around every 65536 units (524.288 milliseconds at 8 MHz).
+ */
+uint16 Timer2_getFineTicks(void)
+{
+	uint16 ticks;
+	uint8 count;
+	uint8 sreg = SREG;
+
+	cli();
+	count = TCNT2;
+	ticks = g_ticks;
+
+	/* A compare match which happened before reading TCNT2 and its ISR is not served yet */
+	if(BIT_IS_SET(TIFR, OCF2) && (count < (TIMER2_FINE_TICKS_PER_TICK / 2)))
+	{
+		ticks++;
+	}
+	SREG = sreg;
+
+	return (ticks * TIMER2_FINE_TICKS_PER_TICK) + count;
+}
@@ -0,0 +1,68 @@
+ /******************************************************************************
+ *
+ * Module: Timer2
+ *
+ * File Name: timer2.h
+ *
+ * Description: Header file for the Timer2 milliseconds tick driver
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef TIMER2_H_
+#define TIMER2_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Timer2 runs in the CTC mode at F_CPU/64 and interrupts every 1 millisecond */
+#define TIMER2_PRESCALER               64
+#define TIMER2_TICKS_PER_SECOND        1000
+#define TIMER2_COMPARE_VALUE           ((F_CPU / TIMER2_PRESCALER / TIMER2_TICKS_PER_SECOND) - 1)
+
+/* One count of the Timer2 register (8 microseconds at 8 MHz), the unit of Timer2_getFineTicks */
+#define TIMER2_FINE_TICK_US            (TIMER2_PRESCALER / (F_CPU / 1000000UL))
+#define TIMER2_FINE_TICKS_PER_TICK     (TIMER2_COMPARE_VALUE + 1)
+
+#if(TIMER2_COMPARE_VALUE > 255)
+
+#error "Timer2 compare value does not fit in OCR2, use a bigger prescaler"
+
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the milliseconds tick, calling it again does not reset the tick counter.
+ * The global interrupt enable bit (I-bit) must be set in the application.
+ */
+void Timer2_startTick(void);
+
+/*
+ * Description :
+ * Return the number of milliseconds since the tick is started, it wraps around every 65.536 seconds.
+ */
+uint16 Timer2_getTicks(void);
+
+/*
+ * Description :
+ * Return TRUE if the required number of milliseconds is passed since the start tick.
+ * It is correct over the wrap around as long as the duration is less than 65.536 seconds.
+ */
+boolean Timer2_isElapsed(uint16 start, uint16 duration_ms);
+
+/*
+ * Description :
+ * Return the time since the tick is started in TIMER2_FINE_TICK_US units, to measure short durations.
+ * It wraps around every 65536 units (524.288 milliseconds at 8 MHz).
+ */
+uint16 Timer2_getFineTicks(void);
+
+#endif /* TIMER2_H_ */
@@ -0,0 +1,17 @@
+ /******************************************************************************
+ *
+ * File Name: interrupt.h
+ *
+ * Description: Host (Linux) stand-in of <avr/interrupt.h>, the model has no interrupts
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#define sei()
+#define cli()
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
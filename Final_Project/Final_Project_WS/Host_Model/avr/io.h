@@ -0,0 +1,17 @@
+ /******************************************************************************
+ *
+ * File Name: io.h
+ *
+ * Description: Host (Linux) stand-in of <avr/io.h> with the registers used by the Control_ECU
+ * sources compiled with the EEPROM model, SREG is defined in eeprom_model.c
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+extern volatile unsigned char SREG;
+
+#endif /* HOST_AVR_IO_H_ */
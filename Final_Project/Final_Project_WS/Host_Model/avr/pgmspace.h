@@ -0,0 +1,18 @@
+ /******************************************************************************
+ *
+ * File Name: pgmspace.h
+ *
+ * Description: Host (Linux) stand-in of <avr/pgmspace.h>, the tables are in the normal memory
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const unsigned char *)(address))
+#define pgm_read_word(address) (*(const unsigned short *)(address))
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,362 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Model
+ *
+ * File Name: eeprom_model.c
+ *
+ * Description: Source file for the host (Linux) model of the 24Cxx EEPROM on the TWI bus,
+ * its memory is an image file mapped by mmap so it is kept between runs.
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include "eeprom_model.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* 3 chip select pins */
+#define EEPROM_MODEL_MAX_DEVICE_ADDRESSES    8
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Host stand-in of the AVR status register used by the compiled Control_ECU sources */
+volatile unsigned char SREG;
+
+static EEPROM_ModelConfigType g_config;
+static uint8 *g_image = NULL_PTR;
+static uint32 g_size = 0;
+static int g_file = -1;
+
+/* Write cycles of each page */
+static uint32 *g_pageWrites = NULL_PTR;
+
+static uint64 g_timeUs = 0;
+
+/* End of the write cycle of each chip */
+static uint64 g_busyUntil[EEPROM_MODEL_MAX_DEVICE_ADDRESSES];
+
+/* The transfer in progress */
+static boolean g_selected = FALSE;
+static uint8 g_chip;
+static uint32 g_deviceBase;          /* First address reached by the selected device address */
+static uint32 g_address;             /* Internal address counter over all the chips */
+static uint8 g_addressBytes;         /* Word address bytes received in this write transfer */
+
+/* Page buffer of a write transfer, stored at STOP */
+static uint8 *g_pageBuffer = NULL_PTR;
+static uint8 *g_pageWritten = NULL_PTR;
+static uint32 g_pageStart;
+static boolean g_pageDirty = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Bytes reached by one device address (256 bytes with 1 address byte, one chip with 2 address bytes
+ * or for the parts smaller than 256 bytes).
+ */
+static uint32 EEPROM_MODEL_deviceSpan(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Map the image file as the memory of the model, a new file (or a file of another size) is created
+ * erased (0xFF). The page write counters start from zero. Returns FALSE if the file cannot be mapped.
+ */
+boolean EEPROM_MODEL_init(const char *imagePath, const EEPROM_ModelConfigType *Config_Ptr)
+{
+	struct stat fileStatus;
+	boolean erase;
+	uint8 i;
+
+	g_config = *Config_Ptr;
+	g_size = g_config.chipSize * g_config.chipsCount;
+
+	if((g_size == 0) || ((g_size / EEPROM_MODEL_deviceSpan()) > EEPROM_MODEL_MAX_DEVICE_ADDRESSES) ||
+	   (g_config.pageSize == 0) || ((g_config.chipSize % g_config.pageSize) != 0))
+	{
+		return FALSE;
+	}
+
+	g_file = open(imagePath, O_RDWR | O_CREAT, 0644);
+	if(g_file < 0)
+	{
+		return FALSE;
+	}
+
+	/* An image of another part is started again erased */
+	erase = (fstat(g_file, &fileStatus) != 0) || ((uint32)fileStatus.st_size != g_size);
+	if(erase && (ftruncate(g_file, g_size) != 0))
+	{
+		close(g_file);
+		g_file = -1;
+		return FALSE;
+	}
+
+	g_image = mmap(NULL_PTR, g_size, PROT_READ | PROT_WRITE, MAP_SHARED, g_file, 0);
+	if(g_image == MAP_FAILED)
+	{
+		g_image = NULL_PTR;
+		close(g_file);
+		g_file = -1;
+		return FALSE;
+	}
+
+	if(erase)
+	{
+		memset(g_image, 0xFF, g_size);
+	}
+
+	g_pageWrites = calloc(g_size / g_config.pageSize, sizeof(uint32));
+	g_pageBuffer = malloc(g_config.pageSize);
+	g_pageWritten = malloc(g_config.pageSize);
+
+	for(i = 0; i < EEPROM_MODEL_MAX_DEVICE_ADDRESSES; i++)
+	{
+		g_busyUntil[i] = 0;
+	}
+	g_selected = FALSE;
+	g_pageDirty = FALSE;
+	g_timeUs = 0;
+
+	return (g_pageWrites != NULL_PTR) && (g_pageBuffer != NULL_PTR) && (g_pageWritten != NULL_PTR);
+}
+
+/*
+ * Description :
+ * Write the image back to its file and unmap it.
+ */
+void EEPROM_MODEL_close(void)
+{
+	if(g_image != NULL_PTR)
+	{
+		msync(g_image, g_size, MS_SYNC);
+		munmap(g_image, g_size);
+		g_image = NULL_PTR;
+	}
+	if(g_file >= 0)
+	{
+		close(g_file);
+		g_file = -1;
+	}
+
+	free(g_pageWrites);
+	free(g_pageBuffer);
+	free(g_pageWritten);
+	g_pageWrites = NULL_PTR;
+	g_pageBuffer = NULL_PTR;
+	g_pageWritten = NULL_PTR;
+}
+
+/*
+ * Description :
+ * START (or repeated START) then the device address, returns TRUE if a chip answers with ACK.
+ * A chip in its write cycle does not answer, this is what the write cycle polling waits for.
+ */
+boolean EEPROM_MODEL_start(uint8 slaveAddress, boolean read)
+{
+	uint8 index = (uint8)(slaveAddress - g_config.baseAddress);
+
+	/* A repeated START keeps the page buffer of the write transfer until the STOP */
+	g_selected = FALSE;
+
+	if((g_image == NULL_PTR) || (slaveAddress < g_config.baseAddress) ||
+	   (((uint32)index * EEPROM_MODEL_deviceSpan()) >= g_size))
+	{
+		return FALSE;
+	}
+
+	g_deviceBase = (uint32)index * EEPROM_MODEL_deviceSpan();
+	g_chip = (uint8)(g_deviceBase / g_config.chipSize);
+
+	if(g_timeUs < g_busyUntil[g_chip])
+	{
+		return FALSE;
+	}
+
+	g_selected = TRUE;
+	g_addressBytes = read ? g_config.addressSize : 0;
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * One written byte, the word address first then the data stored in the page buffer.
+ * The data wraps around to the start of the page like the real part. Returns TRUE for ACK.
+ */
+boolean EEPROM_MODEL_write(uint8 data)
+{
+	uint32 offset;
+
+	if(g_selected == FALSE)
+	{
+		return FALSE;
+	}
+
+	if(g_addressBytes < g_config.addressSize)
+	{
+		/* The word address is inside the span of the device address, high byte first */
+		if(g_addressBytes == 0)
+		{
+			g_address = 0;
+		}
+		g_address = (g_address << 8) | data;
+		g_addressBytes++;
+
+		if(g_addressBytes == g_config.addressSize)
+		{
+			g_address = g_deviceBase + (g_address % EEPROM_MODEL_deviceSpan());
+		}
+		return TRUE;
+	}
+
+	if(g_pageDirty == FALSE)
+	{
+		g_pageStart = g_address - (g_address % g_config.pageSize);
+		memcpy(g_pageBuffer, g_image + g_pageStart, g_config.pageSize);
+		memset(g_pageWritten, 0, g_config.pageSize);
+		g_pageDirty = TRUE;
+	}
+
+	offset = g_address % g_config.pageSize;
+	g_pageBuffer[offset] = data;
+	g_pageWritten[offset] = TRUE;
+	g_address = g_pageStart + ((offset + 1) % g_config.pageSize);
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * One read byte from the internal address counter, it rolls over to the start of the chip.
+ */
+uint8 EEPROM_MODEL_read(void)
+{
+	uint8 data;
+	uint32 chipStart;
+
+	if(g_selected == FALSE)
+	{
+		/* Nobody drives SDA */
+		return 0xFF;
+	}
+
+	chipStart = (uint32)g_chip * g_config.chipSize;
+	data = g_image[g_address];
+	g_address = chipStart + (((g_address - chipStart) + 1) % g_config.chipSize);
+
+	return data;
+}
+
+/*
+ * Description :
+ * STOP, a page write is stored and the chip is busy for its write cycle.
+ */
+void EEPROM_MODEL_stop(void)
+{
+	uint16 i;
+
+	if(g_pageDirty == TRUE)
+	{
+		for(i = 0; i < g_config.pageSize; i++)
+		{
+			if(g_pageWritten[i])
+			{
+				g_image[g_pageStart + i] = g_pageBuffer[i];
+			}
+		}
+		g_pageWrites[g_pageStart / g_config.pageSize]++;
+		g_busyUntil[g_chip] = g_timeUs + g_config.writeCycleUs;
+		g_pageDirty = FALSE;
+	}
+
+	g_selected = FALSE;
+}
+
+/*
+ * Description :
+ * Model time in microseconds.
+ */
+uint64 EEPROM_MODEL_getTimeUs(void)
+{
+	return g_timeUs;
+}
+
+/*
+ * Description :
+ * Advance the model time, called for the bus transfers and the waiting loops.
+ */
+void EEPROM_MODEL_advanceTime(uint32 time_us)
+{
+	g_timeUs += time_us;
+}
+
+/*
+ * Description :
+ * Return the latency added to each transaction.
+ */
+uint32 EEPROM_MODEL_getTransactionLatency(void)
+{
+	return g_config.transactionLatencyUs;
+}
+
+/*
+ * Description :
+ * Return the write cycles of a page, the pages are numbered over all the chips.
+ */
+uint32 EEPROM_MODEL_getPageWrites(uint32 page)
+{
+	if((g_pageWrites == NULL_PTR) || (page >= (g_size / g_config.pageSize)))
+	{
+		return 0;
+	}
+
+	return g_pageWrites[page];
+}
+
+/*
+ * Description :
+ * Return the write cycles of the most written page.
+ */
+uint32 EEPROM_MODEL_getMaxPageWrites(void)
+{
+	uint32 page;
+	uint32 maxWrites = 0;
+
+	for(page = 0; (g_pageWrites != NULL_PTR) && (page < (g_size / g_config.pageSize)); page++)
+	{
+		if(g_pageWrites[page] > maxWrites)
+		{
+			maxWrites = g_pageWrites[page];
+		}
+	}
+
+	return maxWrites;
+}
+
+/*
+ * Description :
+ * Bytes reached by one device address (256 bytes with 1 address byte, one chip with 2 address bytes
+ * or for the parts smaller than 256 bytes).
+ */
+static uint32 EEPROM_MODEL_deviceSpan(void)
+{
+	return ((g_config.addressSize == 1) && (g_config.chipSize > 256)) ? 256 : g_config.chipSize;
+}
@@ -0,0 +1,99 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Model
+ *
+ * File Name: eeprom_model.h
+ *
+ * Description: Header file for the host (Linux) model of the 24Cxx EEPROM on the TWI bus,
+ * its memory is an image file mapped by mmap so it is kept between runs.
+ *
+ * The Control_ECU storage code runs on the host with this model in place of the hardware:
+ * twi_model.c replaces twi.c (the bit rate solver twi_bit_rate.c is shared) and timer2_model.c replaces
+ * timer2.c, the avr/ folder has the few AVR definitions used by the compiled sources. The regression test
+ * test_eeprom.c is built from Final_Project_WS by:
+ *   gcc -DF_CPU=8000000UL -I Host_Model -I Control_ECU -o test_eeprom Host_Model/test_eeprom.c
+ *       Host_Model/eeprom_model.c Host_Model/twi_model.c Host_Model/timer2_model.c
+ *       Control_ECU/twi_bit_rate.c Control_ECU/external_eeprom.c Control_ECU/credential.c
+ *       Control_ECU/crc16.c
+ *
+ * The time is a model time, not the real time: it goes forward only by the bus transfers
+ * (at the SCL frequency of TWI_setBitRate) and the waiting loops, so the code runs at full
+ * speed and its measured times are the ones of the real bus.
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#ifndef EEPROM_MODEL_H_
+#define EEPROM_MODEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* The modeled part and its timing, the sizes are the ones of the EEPROM_... definitions of external_eeprom.h */
+typedef struct
+{
+	uint32 chipSize;              /* Bytes in one chip */
+	uint16 pageSize;              /* Bytes of one page write, the address wraps around inside the page */
+	uint8 addressSize;            /* Bytes of the word address, 1 (24C01 to 24C16) or 2 (24C32 to 24C512) */
+	uint8 chipsCount;             /* Chips with the chip select pins 0, 1, 2 ... */
+	uint8 baseAddress;            /* Device address of the first chip (0x50) */
+	uint32 writeCycleUs;          /* Busy time after a write (tWR), the chip answers its address with NACK */
+	uint32 transactionLatencyUs;  /* Added to each transaction, e.g. the interrupts and the driver code */
+}EEPROM_ModelConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Map the image file as the memory of the model, a new file (or a file of another size) is created
+ * erased (0xFF). The page write counters start from zero. Returns FALSE if the file cannot be mapped.
+ */
+boolean EEPROM_MODEL_init(const char *imagePath, const EEPROM_ModelConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Write the image back to its file and unmap it.
+ */
+void EEPROM_MODEL_close(void);
+
+/*
+ * Description :
+ * Bus side of the model, used by twi_model.c:
+ * start   : START (or repeated START) then the device address, returns TRUE if a chip answers with ACK.
+ * write   : one written byte (the word address then the data), returns TRUE for ACK.
+ * read    : one read byte from the internal address counter.
+ * stop    : STOP, a page write is stored and the chip is busy for its write cycle.
+ */
+boolean EEPROM_MODEL_start(uint8 slaveAddress, boolean read);
+boolean EEPROM_MODEL_write(uint8 data);
+uint8 EEPROM_MODEL_read(void);
+void EEPROM_MODEL_stop(void);
+
+/*
+ * Description :
+ * Model time in microseconds and its advance by the bus transfers and the waiting loops.
+ */
+uint64 EEPROM_MODEL_getTimeUs(void);
+void EEPROM_MODEL_advanceTime(uint32 time_us);
+
+/*
+ * Description :
+ * Return the latency added to each transaction.
+ */
+uint32 EEPROM_MODEL_getTransactionLatency(void);
+
+/*
+ * Description :
+ * Wear of the memory: the write cycles of a page (pages are numbered over all the chips)
+ * and the most written page.
+ */
+uint32 EEPROM_MODEL_getPageWrites(uint32 page);
+uint32 EEPROM_MODEL_getMaxPageWrites(void);
+
+#endif /* EEPROM_MODEL_H_ */
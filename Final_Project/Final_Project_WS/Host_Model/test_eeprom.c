@@ -0,0 +1,336 @@
+ /******************************************************************************
+ *
+ * Module: EEPROM Model
+ *
+ * File Name: test_eeprom.c
+ *
+ * Description: Host (Linux) regression test of the Control_ECU storage code on the 24Cxx EEPROM model:
+ * page wrap around, NACK during the write cycle, transaction latency, password log wrap around,
+ * wear of the log pages and the TWI bit rate. Each check prints PASS or FAIL, the exit code is
+ * the number of failed checks. Built and run from Final_Project_WS:
+ *   gcc -DF_CPU=8000000UL -I Host_Model -I Control_ECU -o test_eeprom Host_Model/test_eeprom.c
+ *       Host_Model/eeprom_model.c Host_Model/twi_model.c Host_Model/timer2_model.c
+ *       Control_ECU/twi_bit_rate.c Control_ECU/external_eeprom.c Control_ECU/credential.c
+ *       Control_ECU/crc16.c
+ *   ./test_eeprom [image file]
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <unistd.h>
+#include "eeprom_model.h"
+#include "external_eeprom.h"
+#include "credential.h"
+#include "timer2.h"
+#include "twi.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_DEFAULT_IMAGE             "test_eeprom.img"
+
+/* Timing of the modeled part */
+#define TEST_WRITE_CYCLE_US            5000
+#define TEST_LATENCY_US                200
+
+/* Saves of the log test, more than the records of the log so it wraps around */
+#define TEST_SAVES_COUNT               (CREDENTIAL_RECORDS_COUNT + 8)
+
+/* The first page of the password log */
+#define TEST_LOG_FIRST_PAGE            (CREDENTIAL_LOG_ADDRESS / EEPROM_PAGE_SIZE)
+#define TEST_LOG_PAGES_COUNT           (CREDENTIAL_LOG_SIZE / EEPROM_PAGE_SIZE)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const char *g_imagePath = TEST_DEFAULT_IMAGE;
+static uint16 g_failures = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Print the result of one check and count it if it failed.
+ */
+static void TEST_check(boolean passed, const char *name);
+
+/*
+ * Description :
+ * Start the model on the image file with the required transaction latency, the image is
+ * erased first if required (a new part) or kept (a reset of the Control_ECU).
+ */
+static boolean TEST_startModel(uint32 latency_us, boolean erase);
+
+/*
+ * Description :
+ * A page write which goes over the page end wraps around to the start of the same page,
+ * and EEPROM_writeBlock splits a block on the page ends.
+ */
+static void TEST_pageWrapAround(void);
+
+/*
+ * Description :
+ * The chip answers its address with NACK until its write cycle is finished,
+ * the measured write cycle is the one of the model.
+ */
+static void TEST_nackDuringWriteCycle(void);
+
+/*
+ * Description :
+ * The configured latency is added once to each transaction.
+ */
+static void TEST_transactionLatency(void);
+
+/*
+ * Description :
+ * The newest password is found after the log wraps around and after a reset, and the saves
+ * are spread over the pages of the log.
+ */
+static void TEST_credentialLog(void);
+
+/*
+ * Description :
+ * The bit rate solver does not go above the fastest SCL frequency of the master.
+ */
+static void TEST_bitRate(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	if(argc > 1)
+	{
+		g_imagePath = argv[1];
+	}
+
+	TEST_pageWrapAround();
+	TEST_nackDuringWriteCycle();
+	TEST_transactionLatency();
+	TEST_credentialLog();
+	TEST_bitRate();
+
+	printf("%u check(s) failed\n", g_failures);
+	return g_failures;
+}
+
+/*
+ * Description :
+ * Print the result of one check and count it if it failed.
+ */
+static void TEST_check(boolean passed, const char *name)
+{
+	printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+	if(!passed)
+	{
+		g_failures++;
+	}
+}
+
+/*
+ * Description :
+ * Start the model on the image file with the required transaction latency, the image is
+ * erased first if required (a new part) or kept (a reset of the Control_ECU).
+ */
+static boolean TEST_startModel(uint32 latency_us, boolean erase)
+{
+	EEPROM_ModelConfigType config = {EEPROM_CHIP_SIZE, EEPROM_PAGE_SIZE, EEPROM_ADDRESS_SIZE, EEPROM_CHIPS_COUNT,
+			EEPROM_BASE_DEVICE_ADDRESS, TEST_WRITE_CYCLE_US, 0};
+
+	config.transactionLatencyUs = latency_us;
+
+	EEPROM_MODEL_close();
+	if(erase)
+	{
+		unlink(g_imagePath);
+	}
+
+	return EEPROM_MODEL_init(g_imagePath, &config);
+}
+
+/*
+ * Description :
+ * A page write which goes over the page end wraps around to the start of the same page,
+ * and EEPROM_writeBlock splits a block on the page ends.
+ */
+static void TEST_pageWrapAround(void)
+{
+	uint8 i;
+	uint8 data[EEPROM_PAGE_SIZE + 4];
+	uint8 page[EEPROM_PAGE_SIZE];
+	boolean passed = TRUE;
+
+	TEST_check(TEST_startModel(0, TRUE), "model started");
+
+	/* 8 bytes from 4 bytes before the end of the second page, written on the bus by hand */
+	EEPROM_MODEL_start(EEPROM_BASE_DEVICE_ADDRESS, FALSE);
+	EEPROM_MODEL_write(2 * EEPROM_PAGE_SIZE - 4);
+	for(i = 0; i < 8; i++)
+	{
+		EEPROM_MODEL_write(i);
+	}
+	EEPROM_MODEL_stop();
+	EEPROM_MODEL_advanceTime(TEST_WRITE_CYCLE_US);
+
+	passed = (EEPROM_readBlock(EEPROM_PAGE_SIZE, page, EEPROM_PAGE_SIZE) == SUCCESS);
+	for(i = 0; i < 4; i++)
+	{
+		passed = passed && (page[EEPROM_PAGE_SIZE - 4 + i] == i) && (page[i] == (uint8)(4 + i));
+	}
+	TEST_check(passed && (EEPROM_MODEL_getPageWrites(1) == 1) && (EEPROM_MODEL_getPageWrites(2) == 0),
+			"page write wraps around inside its page");
+
+	/* A block over a page end is two page writes */
+	for(i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8)(0xA0 + i);
+	}
+	passed = (EEPROM_writeBlock(3 * EEPROM_PAGE_SIZE + 2, data, sizeof(data)) == SUCCESS);
+	for(i = 0; i < sizeof(data); i++)
+	{
+		data[i] = 0;
+	}
+	passed = passed && (EEPROM_readBlock(3 * EEPROM_PAGE_SIZE + 2, data, sizeof(data)) == SUCCESS);
+	for(i = 0; i < sizeof(data); i++)
+	{
+		passed = passed && (data[i] == (uint8)(0xA0 + i));
+	}
+	TEST_check(passed && (EEPROM_MODEL_getPageWrites(3) == 1) && (EEPROM_MODEL_getPageWrites(4) == 1),
+			"block is split on the page ends");
+}
+
+/*
+ * Description :
+ * The chip answers its address with NACK until its write cycle is finished,
+ * the measured write cycle is the one of the model.
+ */
+static void TEST_nackDuringWriteCycle(void)
+{
+	uint16 writeCycle;
+
+	TEST_check(TEST_startModel(0, TRUE), "model started");
+
+	EEPROM_MODEL_start(EEPROM_BASE_DEVICE_ADDRESS, FALSE);
+	EEPROM_MODEL_write(0);
+	EEPROM_MODEL_write(0x55);
+	EEPROM_MODEL_stop();
+
+	TEST_check(EEPROM_MODEL_start(EEPROM_BASE_DEVICE_ADDRESS, FALSE) == FALSE, "NACK during the write cycle");
+	EEPROM_MODEL_stop();
+
+	EEPROM_MODEL_advanceTime(TEST_WRITE_CYCLE_US - 1);
+	TEST_check(EEPROM_MODEL_start(EEPROM_BASE_DEVICE_ADDRESS, FALSE) == FALSE, "NACK until the last microsecond");
+	EEPROM_MODEL_stop();
+
+	EEPROM_MODEL_advanceTime(1);
+	TEST_check(EEPROM_MODEL_start(EEPROM_BASE_DEVICE_ADDRESS, FALSE) == TRUE, "ACK after the write cycle");
+	EEPROM_MODEL_stop();
+
+	/* The driver polls through the NACKs, the time is measured in TIMER2_FINE_TICK_US steps */
+	TEST_check(EEPROM_writeByte(0x10, 0x66) == SUCCESS, "write byte polls through the write cycle");
+	writeCycle = EEPROM_getWriteCycleTime();
+	printf("      measured write cycle: %u us\n", writeCycle);
+	TEST_check((writeCycle >= TEST_WRITE_CYCLE_US - TIMER2_FINE_TICK_US) && (writeCycle <= TEST_WRITE_CYCLE_US + 1000),
+			"measured write cycle matches the model");
+}
+
+/*
+ * Description :
+ * The configured latency is added once to each transaction.
+ */
+static void TEST_transactionLatency(void)
+{
+	uint8 i;
+	uint8 data;
+	uint64 start;
+	uint64 withoutLatency;
+	uint64 withLatency;
+
+	TEST_check(TEST_startModel(0, TRUE), "model started");
+	start = EEPROM_MODEL_getTimeUs();
+	for(i = 0; i < 10; i++)
+	{
+		EEPROM_readByte(i, &data);
+	}
+	withoutLatency = EEPROM_MODEL_getTimeUs() - start;
+
+	TEST_check(TEST_startModel(TEST_LATENCY_US, TRUE), "model started");
+	start = EEPROM_MODEL_getTimeUs();
+	for(i = 0; i < 10; i++)
+	{
+		EEPROM_readByte(i, &data);
+	}
+	withLatency = EEPROM_MODEL_getTimeUs() - start;
+
+	printf("      10 byte reads: %llu us, %llu us with %u us latency\n",
+			(unsigned long long)withoutLatency, (unsigned long long)withLatency, TEST_LATENCY_US);
+	TEST_check((withLatency - withoutLatency) == (10UL * TEST_LATENCY_US), "latency added once per transaction");
+}
+
+/*
+ * Description :
+ * The newest password is found after the log wraps around and after a reset, and the saves
+ * are spread over the pages of the log.
+ */
+static void TEST_credentialLog(void)
+{
+	uint8 i;
+	uint32 page;
+	uint32 writes;
+	uint32 maxWrites = 0;
+	uint32 totalWrites = 0;
+	uint8 password[CREDENTIAL_PASSWORD_SIZE] = {1, 2, 3, 4, 5};
+	uint8 oldPassword[CREDENTIAL_PASSWORD_SIZE] = {1, 2, 3, 4, 5};
+	boolean passed = TRUE;
+
+	TEST_check(TEST_startModel(0, TRUE), "model started");
+	TEST_check(CREDENTIAL_init() == FALSE, "no password in an erased log");
+
+	for(i = 0; i < TEST_SAVES_COUNT; i++)
+	{
+		password[0] = i % (CREDENTIAL_MAX_DIGIT + 1);
+		password[1] = (i / (CREDENTIAL_MAX_DIGIT + 1)) % (CREDENTIAL_MAX_DIGIT + 1);
+		passed = passed && (CREDENTIAL_save(password) == SUCCESS) && (CREDENTIAL_flush() == SUCCESS);
+	}
+	TEST_check(passed, "saves over the log wrap around");
+
+	/* Each save is one page write inside the log, the ring spreads them over its pages */
+	for(page = 0; page < TEST_LOG_PAGES_COUNT; page++)
+	{
+		writes = EEPROM_MODEL_getPageWrites(TEST_LOG_FIRST_PAGE + page);
+		totalWrites += writes;
+		if(writes > maxWrites)
+		{
+			maxWrites = writes;
+		}
+	}
+	printf("      %u saves: %lu log page writes, the most written page has %lu\n",
+			TEST_SAVES_COUNT, (unsigned long)totalWrites, (unsigned long)maxWrites);
+	TEST_check(totalWrites == TEST_SAVES_COUNT, "one page write for each save");
+	TEST_check(maxWrites == EEPROM_MODEL_getMaxPageWrites(), "no page outside the log is written more");
+	TEST_check(maxWrites <= (((TEST_SAVES_COUNT + CREDENTIAL_RECORDS_COUNT - 1) / CREDENTIAL_RECORDS_COUNT) *
+			(EEPROM_PAGE_SIZE / CREDENTIAL_RECORD_SIZE)), "writes spread over the log pages");
+
+	/* A reset of the Control_ECU keeps the image, the scan finds the newest record */
+	TEST_check(TEST_startModel(0, FALSE), "model started again on the same image");
+	TEST_check(CREDENTIAL_init() == TRUE, "password found after the reset");
+	TEST_check(CREDENTIAL_check(password) == TRUE, "newest password matches");
+	TEST_check(CREDENTIAL_check(oldPassword) == FALSE, "first password does not match");
+}
+
+/*
+ * Description :
+ * The bit rate solver does not go above the fastest SCL frequency of the master.
+ */
+static void TEST_bitRate(void)
+{
+	TEST_check(TWI_setBitRate(TWI_SCL_100KHZ) == TWI_SCL_100KHZ, "100 kHz is exact");
+	TEST_check(TWI_setBitRate(TWI_SCL_400KHZ) == TWI_SCL_MAX_HZ, "400 kHz is limited by the minimum TWBR");
+}
@@ -0,0 +1,54 @@
+ /******************************************************************************
+ *
+ * Module: Timer2 Model
+ *
+ * File Name: timer2_model.c
+ *
+ * Description: Host (Linux) stand-in of timer2.c, the ticks are counted from the model time
+ * of eeprom_model.c
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include "timer2.h"
+#include "eeprom_model.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * The model time is always running.
+ */
+void Timer2_startTick(void)
+{
+}
+
+/*
+ * Description :
+ * Return the number of milliseconds of the model time, it wraps around every 65.536 seconds.
+ */
+uint16 Timer2_getTicks(void)
+{
+	return (uint16)(EEPROM_MODEL_getTimeUs() / (1000000UL / TIMER2_TICKS_PER_SECOND));
+}
+
+/*
+ * Description :
+ * Return TRUE if the required number of milliseconds is passed since the start tick.
+ */
+boolean Timer2_isElapsed(uint16 start, uint16 duration_ms)
+{
+	return ((uint16)(Timer2_getTicks() - start) >= duration_ms);
+}
+
+/*
+ * Description :
+ * Return the model time in TIMER2_FINE_TICK_US units, it wraps around every 65536 units.
+ */
+uint16 Timer2_getFineTicks(void)
+{
+	return (uint16)(EEPROM_MODEL_getTimeUs() / TIMER2_FINE_TICK_US);
+}
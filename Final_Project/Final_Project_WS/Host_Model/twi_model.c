@@ -0,0 +1,340 @@
+ /******************************************************************************
+ *
+ * Module: TWI(I2C) Model
+ *
+ * File Name: twi_model.c
+ *
+ * Description: Host (Linux) stand-in of twi.c, the functions of twi.h run the transactions
+ * on the 24Cxx EEPROM model of eeprom_model.c
+ *
+ * The queued transactions are run at once in the submit function, one after the other like the
+ * TWI ISR does: the call-back functions are called in the same order and a transaction submitted
+ * by a call-back function is run after the current one. Each byte on the bus takes 9 SCL periods
+ * of the model time.
+ *
+ * Author: Peter Nabil
+ *
+ *******************************************************************************/
+
+#include "twi.h"
+#include "eeprom_model.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Model time of one poll of a waiting loop, so a loop on the time always ends */
+#define TWI_MODEL_WAIT_POLL_US         1
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static TWI_TransactionType *g_queueHead = NULL_PTR;
+static TWI_TransactionType *g_queueTail = NULL_PTR;
+
+/* Set while the queue is run, a transaction submitted by a call-back function is run by the same loop */
+static boolean g_running = FALSE;
+
+static uint32 g_sclHz = TWI_SCL_MAX_HZ;
+
+/* Status of the polling functions (TWI_start ... TWI_readByteWithNACK) */
+static uint8 g_status = TWI_BUS_ERROR;
+static boolean g_busActive = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Advance the model time by the required number of SCL periods.
+ */
+static void TWI_MODEL_busTime(uint32 periods);
+
+/*
+ * Description :
+ * Run one transaction on the EEPROM model and return its status.
+ */
+static TWI_TransactionStatus TWI_MODEL_run(TWI_TransactionType *transaction);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Only the SCL frequency is used by the model.
+ */
+void TWI_init(const TWI_ConfigType * Config_Ptr)
+{
+	uint8 prescaler = (uint8)(Config_Ptr->prescaler & 0x03);
+
+	g_sclHz = F_CPU / (16 + (2UL * Config_Ptr->bit_rate * (1UL << (2 * prescaler))));
+}
+
+/*
+ * Description :
+ * Only the SCL frequency is used by the model. Returns the real SCL frequency.
+ */
+uint32 TWI_initHz(uint32 scl_hz)
+{
+	return TWI_setBitRate(scl_hz);
+}
+
+/*
+ * Description :
+ * The TWBR and the prescaler are found by TWI_findBitRate of twi_bit_rate.c like twi.c does,
+ * the model bus runs at the real SCL frequency.
+ */
+uint32 TWI_setBitRate(uint32 scl_hz)
+{
+	uint8 bitRate;
+	uint8 prescaler;
+
+	g_sclHz = TWI_findBitRate(scl_hz, &bitRate, &prescaler);
+
+	return g_sclHz;
+}
+
+/*
+ * Description :
+ * Add a transaction to the queue and run the queue at once if it is not running.
+ */
+void TWI_submitTransaction(TWI_TransactionType *transaction)
+{
+	TWI_TransactionType *running;
+
+	transaction->status = TWI_TRANSACTION_PENDING;
+	transaction->next = NULL_PTR;
+
+	if(g_queueHead == NULL_PTR)
+	{
+		g_queueHead = transaction;
+	}
+	else
+	{
+		g_queueTail->next = transaction;
+	}
+	g_queueTail = transaction;
+
+	if(g_running == TRUE)
+	{
+		return;
+	}
+
+	g_running = TRUE;
+	while(g_queueHead != NULL_PTR)
+	{
+		running = g_queueHead;
+		running->status = TWI_TRANSACTION_BUSY;
+		EEPROM_MODEL_advanceTime(EEPROM_MODEL_getTransactionLatency());
+
+		/* The status is set before the call-back function like TWI_finishTransaction */
+		running->status = TWI_MODEL_run(running);
+		g_queueHead = running->next;
+		if(g_queueHead == NULL_PTR)
+		{
+			g_queueTail = NULL_PTR;
+		}
+
+		if(running->callBack != NULL_PTR)
+		{
+			(*running->callBack)(running);
+		}
+	}
+	g_running = FALSE;
+}
+
+/*
+ * Description :
+ * The transactions are finished by the submit function.
+ */
+TWI_TransactionStatus TWI_waitTransaction(const TWI_TransactionType *transaction)
+{
+	return transaction->status;
+}
+
+/*
+ * Description :
+ * Return TRUE if the queue is not running.
+ */
+boolean TWI_isIdle(void)
+{
+	return (g_running == FALSE);
+}
+
+/*
+ * Description :
+ * The model bus never gets stuck, only the model time of the waiting loop goes forward.
+ */
+void TWI_checkTimeout(void)
+{
+	EEPROM_MODEL_advanceTime(TWI_MODEL_WAIT_POLL_US);
+}
+
+/*
+ * Description :
+ * The model bus is always free, the STOP condition ends any transfer.
+ */
+boolean TWI_recoverBus(void)
+{
+	TWI_MODEL_busTime(TWI_RECOVERY_CLOCKS + 1);
+	EEPROM_MODEL_stop();
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * START condition for the polling functions.
+ */
+void TWI_start(void)
+{
+	TWI_MODEL_busTime(1);
+	g_status = (g_busActive == TRUE) ? TWI_REP_START : TWI_START;
+	g_busActive = TRUE;
+}
+
+/*
+ * Description :
+ * STOP condition for the polling functions.
+ */
+void TWI_stop(void)
+{
+	TWI_MODEL_busTime(1);
+	EEPROM_MODEL_stop();
+	g_busActive = FALSE;
+}
+
+/*
+ * Description :
+ * Write the device address (after a START) or a data byte for the polling functions.
+ */
+void TWI_writeByte(uint8 data)
+{
+	TWI_MODEL_busTime(9);
+
+	if((g_status == TWI_START) || (g_status == TWI_REP_START))
+	{
+		boolean reading = (data & 0x01) ? TRUE : FALSE;
+
+		if(EEPROM_MODEL_start((uint8)(data >> 1), reading))
+		{
+			g_status = reading ? TWI_MT_SLA_R_ACK : TWI_MT_SLA_W_ACK;
+		}
+		else
+		{
+			g_status = reading ? TWI_MT_SLA_R_NACK : TWI_MT_SLA_W_NACK;
+		}
+	}
+	else
+	{
+		g_status = EEPROM_MODEL_write(data) ? TWI_MT_DATA_ACK : TWI_MT_DATA_NACK;
+	}
+}
+
+/*
+ * Description :
+ * Read a byte with ACK for the polling functions.
+ */
+uint8 TWI_readByteWithACK(void)
+{
+	TWI_MODEL_busTime(9);
+	g_status = TWI_MR_DATA_ACK;
+
+	return EEPROM_MODEL_read();
+}
+
+/*
+ * Description :
+ * Read a byte with NACK for the polling functions.
+ */
+uint8 TWI_readByteWithNACK(void)
+{
+	TWI_MODEL_busTime(9);
+	g_status = TWI_MR_DATA_NACK;
+
+	return EEPROM_MODEL_read();
+}
+
+/*
+ * Description :
+ * Return the status of the last polling function.
+ */
+uint8 TWI_getStatus(void)
+{
+	return g_status;
+}
+
+/*
+ * Description :
+ * Advance the model time by the required number of SCL periods.
+ */
+static void TWI_MODEL_busTime(uint32 periods)
+{
+	EEPROM_MODEL_advanceTime((uint32)(((uint64)periods * 1000000UL + g_sclHz - 1) / g_sclHz));
+}
+
+/*
+ * Description :
+ * Run one transaction on the EEPROM model and return its status:
+ * START, SLA+W, the memory address and the write bytes, then a repeated START, SLA+R and the read bytes, then STOP.
+ */
+static TWI_TransactionStatus TWI_MODEL_run(TWI_TransactionType *transaction)
+{
+	uint8 i;
+	TWI_TransactionStatus status = TWI_TRANSACTION_DONE;
+	boolean readOnly = (transaction->memoryAddressLength == 0) && (transaction->writeLength == 0) &&
+	                   (transaction->readLength != 0);
+
+	/* START and the device address */
+	TWI_MODEL_busTime(1 + 9);
+	if(!EEPROM_MODEL_start(transaction->slaveAddress, readOnly))
+	{
+		status = TWI_TRANSACTION_ADDRESS_NACK;
+	}
+
+	if((status == TWI_TRANSACTION_DONE) && !readOnly)
+	{
+		for(i = 0; (i < transaction->memoryAddressLength) && (status == TWI_TRANSACTION_DONE); i++)
+		{
+			TWI_MODEL_busTime(9);
+			if(!EEPROM_MODEL_write(transaction->memoryAddress[i]))
+			{
+				status = TWI_TRANSACTION_DATA_NACK;
+			}
+		}
+
+		for(i = 0; (i < transaction->writeLength) && (status == TWI_TRANSACTION_DONE); i++)
+		{
+			TWI_MODEL_busTime(9);
+			if(!EEPROM_MODEL_write(transaction->writeData[i]))
+			{
+				status = TWI_TRANSACTION_DATA_NACK;
+			}
+		}
+
+		/* Repeated START to turn the bus direction for reading */
+		if((status == TWI_TRANSACTION_DONE) && (transaction->readLength != 0))
+		{
+			TWI_MODEL_busTime(1 + 9);
+			if(!EEPROM_MODEL_start(transaction->slaveAddress, TRUE))
+			{
+				status = TWI_TRANSACTION_ADDRESS_NACK;
+			}
+		}
+	}
+
+	for(i = 0; (i < transaction->readLength) && (status == TWI_TRANSACTION_DONE); i++)
+	{
+		TWI_MODEL_busTime(9);
+		transaction->readData[i] = EEPROM_MODEL_read();
+	}
+
+	/* STOP, a written page is stored now */
+	TWI_MODEL_busTime(1);
+	EEPROM_MODEL_stop();
+
+	return status;
+}